@@ -0,0 +1,51 @@
+#include "../my/concurrent_vector.h"
+#include "../my/vector.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+
+// Appends from 1 to 64 threads into one shared container: a mutex around
+// my::vector::emplace_back against lock-free my::concurrent_vector.
+
+namespace {
+
+constexpr std::int64_t PUSHES_PER_ITERATION = 1024;
+
+struct locked_vector {
+  std::mutex mutex;
+  my::vector<std::uint64_t> data;
+
+  void push_back(std::uint64_t value) {
+    std::lock_guard lock(mutex);
+    data.emplace_back(value);
+  }
+};
+
+template <class Container> void BM_SharedAppend(benchmark::State &state) {
+  static std::unique_ptr<Container> shared;
+  if (state.thread_index() == 0) {
+    shared = std::make_unique<Container>();
+  }
+
+  // the benchmark library starts timing only once every thread is here, so
+  // thread 0 has created the container by then
+  for (auto _ : state) {
+    for (std::int64_t i = 0; i < PUSHES_PER_ITERATION; ++i) {
+      shared->push_back(static_cast<std::uint64_t>(i));
+    }
+  }
+  state.SetItemsProcessed(state.iterations() * PUSHES_PER_ITERATION);
+
+  if (state.thread_index() == 0) {
+    shared.reset();
+  }
+}
+
+BENCHMARK(BM_SharedAppend<locked_vector>)->ThreadRange(1, 64)->UseRealTime();
+BENCHMARK(BM_SharedAppend<my::concurrent_vector<std::uint64_t>>)
+    ->ThreadRange(1, 64)
+    ->UseRealTime();
+} // namespace
+
+BENCHMARK_MAIN();
@@ -0,0 +1,53 @@
+#include "../my/huge_page_resource.h"
+#include "../my/vector.h"
+#include <benchmark/benchmark.h>
+#include <cstdint>
+#include <random>
+
+// Random gather over a table that is far larger than what the TLB covers
+// with 4 KB pages. Arg is the table size in MiB.
+
+namespace {
+
+constexpr std::size_t GATHER_COUNT = 1 << 16;
+
+std::vector<std::uint32_t> make_indices(std::size_t size) {
+  std::mt19937_64 rng{42};
+  std::uniform_int_distribution<std::uint32_t> dist(
+      0, static_cast<std::uint32_t>(size - 1));
+  std::vector<std::uint32_t> indices(GATHER_COUNT);
+  for (auto &i : indices) {
+    i = dist(rng);
+  }
+  return indices;
+}
+
+template <class Table> void BM_RandomGather(benchmark::State &state) {
+  auto bytes = static_cast<std::size_t>(state.range(0)) << 20;
+  Table table(bytes / sizeof(std::uint64_t), std::uint64_t{1});
+  auto indices = make_indices(table.size());
+
+  for (auto _ : state) {
+    std::uint64_t sum = 0;
+    for (auto i : indices) {
+      sum += table[i];
+    }
+    benchmark::DoNotOptimize(sum);
+  }
+  state.SetItemsProcessed(state.iterations() *
+                          static_cast<std::int64_t>(indices.size()));
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<std::int64_t>(indices.size() *
+                                                    sizeof(std::uint64_t)));
+}
+
+using normal_table = my::vector<std::uint64_t>;
+using huge_table =
+    my::vector<std::uint64_t, my::huge_page_allocator<std::uint64_t>>;
+
+} // namespace
+
+BENCHMARK(BM_RandomGather<normal_table>)->RangeMultiplier(4)->Range(64, 4096);
+BENCHMARK(BM_RandomGather<huge_table>)->RangeMultiplier(4)->Range(64, 4096);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,205 @@
+#include "../my/list.h"
+#include "../my/pool_allocator.h"
+#include "../my/vector.h"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <list>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// my::vector against std::vector and my::list against std::list: growth,
+// insert/erase at the front, middle and back, copy and move; my::list runs
+// once more with its nodes in a my::pool_allocator. Each benchmark takes the
+// working set in bytes (sizeof(T) per element), from L1 resident to DRAM
+// resident, for int, std::string, std::unique_ptr<int> and a 256-byte POD.
+// Results also go to my_stl_bench.json unless --benchmark_out is given.
+
+namespace {
+
+struct pod256 {
+  std::array<std::uint64_t, 32> words;
+};
+static_assert(sizeof(pod256) == 256);
+
+// strings are longer than the small string buffer so that each one owns a
+// heap block, like the unique_ptrs
+template <class T> T make_value(std::size_t i) {
+  if constexpr (std::is_same_v<T, int>) {
+    return static_cast<int>(i);
+  } else if constexpr (std::is_same_v<T, std::string>) {
+    return "a string that does not fit the SSO " + std::to_string(i);
+  } else if constexpr (std::is_same_v<T, std::unique_ptr<int>>) {
+    return std::make_unique<int>(static_cast<int>(i));
+  } else {
+    pod256 p{};
+    p.words.fill(i);
+    return p;
+  }
+}
+
+template <class Container> using value_t = typename Container::value_type;
+
+template <class Container> std::size_t element_count(benchmark::State &state) {
+  auto bytes = static_cast<std::size_t>(state.range(0));
+  return std::max<std::size_t>(1, bytes / sizeof(value_t<Container>));
+}
+
+template <class Container> Container make_container(std::size_t n) {
+  Container c;
+  for (std::size_t i = 0; i < n; ++i) {
+    c.push_back(make_value<value_t<Container>>(i));
+  }
+  return c;
+}
+
+template <class Container>
+void set_counters(benchmark::State &state, std::size_t items) {
+  state.SetItemsProcessed(
+      static_cast<std::int64_t>(state.iterations() * items));
+  state.counters["elements"] =
+      static_cast<double>(element_count<Container>(state));
+}
+
+template <class Container> void BM_PushBack(benchmark::State &state) {
+  auto n = element_count<Container>(state);
+  for (auto _ : state) {
+    Container c;
+    for (std::size_t i = 0; i < n; ++i) {
+      c.push_back(make_value<value_t<Container>>(i));
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  set_counters<Container>(state, n);
+}
+
+template <class Container> void BM_EmplaceBack(benchmark::State &state) {
+  auto n = element_count<Container>(state);
+  for (auto _ : state) {
+    Container c;
+    for (std::size_t i = 0; i < n; ++i) {
+      c.emplace_back(make_value<value_t<Container>>(i));
+    }
+    benchmark::DoNotOptimize(c);
+  }
+  set_counters<Container>(state, n);
+}
+
+enum class position { front, middle, back };
+
+// one insert and one erase at the same place per iteration, so the size
+// stays put; the list keeps its iterator, the vector recomputes the index
+template <class Container, position Where>
+void BM_InsertErase(benchmark::State &state) {
+  auto n = element_count<Container>(state);
+  auto c = make_container<Container>(n);
+  auto at = [&] {
+    if constexpr (Where == position::front) {
+      return c.begin();
+    } else if constexpr (Where == position::back) {
+      return c.end();
+    } else {
+      return std::next(c.begin(), static_cast<std::ptrdiff_t>(n / 2));
+    }
+  };
+  auto pos = at();
+  std::size_t i = 0;
+  for (auto _ : state) {
+    if constexpr (std::random_access_iterator<typename Container::iterator>) {
+      pos = at();
+    }
+    auto it = c.insert(pos, make_value<value_t<Container>>(i++));
+    pos = c.erase(it);
+    benchmark::ClobberMemory();
+  }
+  set_counters<Container>(state, 1);
+}
+
+template <class Container> void BM_Copy(benchmark::State &state) {
+  auto n = element_count<Container>(state);
+  auto c = make_container<Container>(n);
+  for (auto _ : state) {
+    Container copy(c);
+    benchmark::DoNotOptimize(copy);
+  }
+  set_counters<Container>(state, n);
+}
+
+template <class Container> void BM_Move(benchmark::State &state) {
+  auto n = element_count<Container>(state);
+  auto c = make_container<Container>(n);
+  for (auto _ : state) {
+    Container moved(std::move(c));
+    benchmark::DoNotOptimize(moved);
+    c = std::move(moved);
+  }
+  set_counters<Container>(state, n);
+}
+
+// 16 KiB (L1) up to 64 MiB (DRAM)
+void working_sets(benchmark::internal::Benchmark *b) {
+  for (std::int64_t bytes : {16 << 10, 256 << 10, 4 << 20, 64 << 20}) {
+    b->Arg(bytes);
+  }
+}
+
+template <class Container> void register_container(const std::string &name) {
+  auto add = [&](const char *op, auto fn) {
+    benchmark::RegisterBenchmark((op + ("<" + name + ">")).c_str(), fn)
+        ->Apply(working_sets);
+  };
+  add("BM_PushBack", BM_PushBack<Container>);
+  add("BM_EmplaceBack", BM_EmplaceBack<Container>);
+  add("BM_InsertErase/front", BM_InsertErase<Container, position::front>);
+  add("BM_InsertErase/middle", BM_InsertErase<Container, position::middle>);
+  add("BM_InsertErase/back", BM_InsertErase<Container, position::back>);
+  if constexpr (std::is_copy_constructible_v<value_t<Container>>) {
+    add("BM_Copy", BM_Copy<Container>);
+  }
+  add("BM_Move", BM_Move<Container>);
+}
+
+template <class T> void register_type(const std::string &type) {
+  register_container<std::vector<T>>("std::vector<" + type + ">");
+  register_container<my::vector<T>>("my::vector<" + type + ">");
+  register_container<std::list<T>>("std::list<" + type + ">");
+  register_container<my::list<T>>("my::list<" + type + ">");
+  register_container<my::list<T, my::pool_allocator<T>>>("my::list<" + type +
+                                                          ", pool>");
+}
+} // namespace
+
+int main(int argc, char **argv) {
+  register_type<int>("int");
+  register_type<std::string>("string");
+  register_type<std::unique_ptr<int>>("unique_ptr");
+  register_type<pod256>("pod256");
+
+  // JSON next to the console output unless the caller chose a file
+  std::vector<char *> args(argv, argv + argc);
+  std::string out = "--benchmark_out=my_stl_bench.json";
+  std::string format = "--benchmark_out_format=json";
+  bool has_out = false;
+  for (int i = 1; i < argc; ++i) {
+    has_out |= std::string_view(argv[i]).starts_with("--benchmark_out=");
+  }
+  if (!has_out) {
+    args.push_back(out.data());
+    args.push_back(format.data());
+  }
+  int count = static_cast<int>(args.size());
+
+  benchmark::Initialize(&count, args.data());
+  if (benchmark::ReportUnrecognizedArguments(count, args.data())) {
+    return 1;
+  }
+  benchmark::RunSpecifiedBenchmarks();
+  benchmark::Shutdown();
+  return 0;
+}
@@ -1,5 +1,18 @@
 #pragma once
+#include <algorithm>
+#include <bit>
 #include <cstddef>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <new>
+#include <type_traits>
+
+#if defined(__APPLE__)
+#include <malloc/malloc.h>
+#elif defined(__linux__)
+#include <malloc.h>
+#endif
 
 template <class Pointer> struct allocation_result {
   Pointer ptr;
@@ -8,7 +21,27 @@ template <class Pointer> struct allocation_result {
 
 namespace my {
 
-template <class T> struct allocator {
+namespace detail {
+// number of bytes actually usable in a block returned by std::malloc, which
+// is usually a bit more than what was asked for
+inline std::size_t
+usable_size(void *p, [[maybe_unused]] std::size_t requested) noexcept {
+#if defined(__APPLE__)
+  return malloc_size(p);
+#elif defined(__linux__)
+  return malloc_usable_size(p);
+#else
+  (void)p;
+  return requested;
+#endif
+}
+} // namespace detail
+
+// Align raises the alignment of every block above alignof(T), e.g. to a
+// cache line or a SIMD register width; 0 keeps alignof(T).
+template <class T, std::size_t Align = 0> struct allocator {
+  static_assert(Align == 0 || std::has_single_bit(Align),
+                "my::allocator: alignment must be a power of two");
 
   using value_type = T;
   using size_type = std::size_t;
@@ -17,20 +50,80 @@ template <class T> struct allocator {
   using const_pointer = const T *;
   using reference = T &;
   using const_reference = const T &;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  static constexpr std::size_t alignment = std::max(Align, alignof(T));
+
+  // allocator_traits can't rebind past the non-type parameter on its own
+  template <class U> struct rebind {
+    using other = allocator<U, Align>;
+  };
 
+  constexpr allocator() noexcept = default;
+  template <class U>
+  constexpr allocator(const allocator<U, Align> &) noexcept {}
+
+  // memory comes from std::malloc rather than ::operator new, so that
+  // allocate_at_least can ask the C allocator how big the block really is.
+  // malloc only aligns to max_align_t; stricter alignments go to the
+  // std::align_val_t overloads of ::operator new, which can't report spare
+  // room.
   [[nodiscard]] constexpr pointer allocate(size_type n) {
-    if (n == 0)
-      return nullptr;
-    return static_cast<pointer>(::operator new(n * sizeof(value_type)));
+    return allocate_at_least(n).ptr;
   }
 
+  // constant evaluation can't call malloc, it goes through std::allocator;
+  // such memory never outlives the evaluation, so it can't reach deallocate
+  // at run time
   [[nodiscard]] constexpr allocation_result<pointer>
-  allocate_at_least(size_t n);
+  allocate_at_least(size_type n) {
+    if (n == 0)
+      return {nullptr, 0};
+    if (n > std::numeric_limits<size_type>::max() / sizeof(value_type))
+      throw std::bad_array_new_length();
+    if consteval {
+      return {std::allocator<T>{}.allocate(n), n};
+    }
+
+    if constexpr (over_aligned) {
+      void *raw = ::operator new(n * sizeof(value_type),
+                                 std::align_val_t{alignment});
+      return {static_cast<pointer>(raw), n};
+    } else {
+      void *raw = std::malloc(n * sizeof(value_type));
+      if (raw == nullptr)
+        throw std::bad_alloc();
 
-  constexpr void deallocate(pointer p, size_t /* n */) {
+      auto bytes = detail::usable_size(raw, n * sizeof(value_type));
+      return {static_cast<pointer>(raw), bytes / sizeof(value_type)};
+    }
+  }
+
+  constexpr void deallocate(pointer p, size_type n) {
     if (p == nullptr)
       return;
-    ::operator delete(p);
+    if consteval {
+      std::allocator<T>{}.deallocate(p, n);
+      return;
+    }
+    if constexpr (over_aligned) {
+      ::operator delete(p, n * sizeof(value_type),
+                        std::align_val_t{alignment});
+    } else {
+      std::free(p);
+    }
   }
+
+  template <class U>
+  friend constexpr bool operator==(const allocator &,
+                                   const allocator<U, Align> &) noexcept {
+    return true;
+  }
+
+private:
+  static constexpr bool over_aligned =
+      alignment > alignof(std::max_align_t);
 };
+
 } // namespace my
@@ -0,0 +1,403 @@
+#pragma once
+#include "allocator.h"
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Append-only vector that any number of threads may grow at once. A writer
+// claims its slots with one fetch_add on the size, so appends never take a
+// lock. Storage is a fixed table of segments whose sizes double (B, 2B, 4B,
+// ...), allocated on first use and published with a CAS; elements never
+// move, so readers index without locks and references stay valid.
+//
+// size() counts claimed slots. An element may be read once the call that
+// appended it has returned in the reading thread's view (the same rule as
+// for any other shared object); reading a slot that is still being
+// constructed is a data race.
+//
+// Appending, operator[], at() and reserve() are safe to call concurrently,
+// everything else (clear, assignment, swap) needs exclusive access. An
+// element constructor that throws leaves a value-initialized element behind
+// so every claimed slot always holds an object; hence T must be nothrow
+// default constructible. Running out of memory for a new segment is not
+// recoverable this way: the vector may only be destroyed afterwards if no
+// slot in that segment was claimed.
+template <class T, class Allocator = allocator<T>> class concurrent_vector {
+  static_assert(std::is_nothrow_default_constructible_v<T>,
+                "my::concurrent_vector: T must be nothrow default "
+                "constructible");
+
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+
+  // elements in the first segment, every later one doubles
+  static constexpr size_type first_segment_size =
+      std::max<size_type>(8, std::bit_floor(4096 / sizeof(T)));
+
+  template <bool Const> class segment_iterator {
+    template <bool> friend class segment_iterator;
+    using container = std::conditional_t<Const, const concurrent_vector,
+                                         concurrent_vector>;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T *, T *>;
+    using reference = std::conditional_t<Const, const T &, T &>;
+
+    segment_iterator() noexcept = default;
+    segment_iterator(container *c, size_type idx) noexcept
+        : m_c{c}, m_idx{idx} {}
+    template <bool C = Const>
+      requires C
+    segment_iterator(const segment_iterator<false> &other) noexcept
+        : m_c{other.m_c}, m_idx{other.m_idx} {}
+
+    reference operator*() const noexcept { return (*m_c)[m_idx]; }
+    pointer operator->() const noexcept { return &**this; }
+    reference operator[](difference_type n) const noexcept {
+      return *(*this + n);
+    }
+
+    segment_iterator &operator++() noexcept {
+      ++m_idx;
+      return *this;
+    }
+    segment_iterator operator++(int) noexcept {
+      auto tmp = *this;
+      ++m_idx;
+      return tmp;
+    }
+    segment_iterator &operator--() noexcept {
+      --m_idx;
+      return *this;
+    }
+    segment_iterator operator--(int) noexcept {
+      auto tmp = *this;
+      --m_idx;
+      return tmp;
+    }
+    segment_iterator &operator+=(difference_type n) noexcept {
+      m_idx = static_cast<size_type>(static_cast<difference_type>(m_idx) + n);
+      return *this;
+    }
+    segment_iterator &operator-=(difference_type n) noexcept {
+      return *this += -n;
+    }
+    friend segment_iterator operator+(segment_iterator it,
+                                      difference_type n) noexcept {
+      return it += n;
+    }
+    friend segment_iterator operator+(difference_type n,
+                                      segment_iterator it) noexcept {
+      return it += n;
+    }
+    friend segment_iterator operator-(segment_iterator it,
+                                      difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const segment_iterator &a,
+                                     const segment_iterator &b) noexcept {
+      return static_cast<difference_type>(a.m_idx) -
+             static_cast<difference_type>(b.m_idx);
+    }
+    friend bool operator==(const segment_iterator &a,
+                           const segment_iterator &b) noexcept {
+      return a.m_idx == b.m_idx;
+    }
+    friend auto operator<=>(const segment_iterator &a,
+                            const segment_iterator &b) noexcept {
+      return a.m_idx <=> b.m_idx;
+    }
+
+    // position in the vector
+    size_type index() const noexcept { return m_idx; }
+
+  private:
+    container *m_c = nullptr;
+    size_type m_idx = 0;
+  };
+
+  using iterator = segment_iterator<false>;
+  using const_iterator = segment_iterator<true>;
+
+private:
+  using alloc_traits = std::allocator_traits<allocator_type>;
+
+  static constexpr size_type first_shift =
+      std::countr_zero(first_segment_size);
+  static constexpr size_type max_segments =
+      std::numeric_limits<size_type>::digits - first_shift;
+
+  static constexpr size_type segment_of(size_type idx) noexcept {
+    return static_cast<size_type>(std::bit_width(idx + first_segment_size)) -
+           1 - first_shift;
+  }
+  static constexpr size_type segment_begin(size_type seg) noexcept {
+    return (first_segment_size << seg) - first_segment_size;
+  }
+  static constexpr size_type segment_size(size_type seg) noexcept {
+    return first_segment_size << seg;
+  }
+
+  // returns segment seg, allocating it if no thread has yet. Racing threads
+  // each allocate; one CAS wins and the rest give their block back. Since
+  // segments double this happens O(log n) times over the vector's life.
+  pointer segment(size_type seg) {
+    auto *p = m_segments[seg].load(std::memory_order_acquire);
+    if (p != nullptr)
+      return p;
+    auto *fresh = alloc_traits::allocate(m_alloc, segment_size(seg));
+    if (m_segments[seg].compare_exchange_strong(p, fresh,
+                                                std::memory_order_acq_rel,
+                                                std::memory_order_acquire)) {
+      return fresh;
+    }
+    alloc_traits::deallocate(m_alloc, fresh, segment_size(seg));
+    return p;
+  }
+
+  pointer slot(size_type idx) const noexcept {
+    auto seg = segment_of(idx);
+    // always true for an index below max_size(), but GCC can't see that
+    // and warns about reading past m_segments
+    assert(seg < max_segments);
+    if (seg >= max_segments)
+      std::unreachable();
+    return m_segments[seg].load(std::memory_order_acquire) +
+           (idx - segment_begin(seg));
+  }
+
+  // builds the count claimed slots from first on with construct(p)
+  template <class Construct>
+  void construct_range(size_type first, size_type count, Construct construct) {
+    if (count == 0)
+      return;
+    auto last_seg = segment_of(first + count - 1);
+    for (auto seg = segment_of(first); seg <= last_seg; ++seg) {
+      segment(seg);
+    }
+    for (size_type i = 0; i < count; ++i) {
+      try {
+        construct(slot(first + i));
+      } catch (...) {
+        // keep every claimed slot alive, then report the failure
+        for (size_type j = i; j < count; ++j) {
+          ::new (static_cast<void *>(slot(first + j))) T();
+        }
+        throw;
+      }
+    }
+  }
+
+  void destroy_all() noexcept {
+    auto n = m_size.load(std::memory_order_relaxed);
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_type i = 0; i < n; ++i) {
+        alloc_traits::destroy(m_alloc, slot(i));
+      }
+    }
+    m_size.store(0, std::memory_order_relaxed);
+  }
+
+  void release() noexcept {
+    for (size_type seg = 0; seg < max_segments; ++seg) {
+      auto *p = m_segments[seg].exchange(nullptr, std::memory_order_relaxed);
+      if (p != nullptr)
+        alloc_traits::deallocate(m_alloc, p, segment_size(seg));
+    }
+  }
+
+  std::array<std::atomic<pointer>, max_segments> m_segments{};
+  std::atomic<size_type> m_size{0};
+  [[no_unique_address]] allocator_type m_alloc;
+
+public:
+  // ctor
+  concurrent_vector() noexcept(noexcept(Allocator()))
+      : concurrent_vector(Allocator()) {}
+  explicit concurrent_vector(const Allocator &alloc) noexcept
+      : m_alloc{alloc} {}
+  explicit concurrent_vector(size_type count,
+                             const Allocator &alloc = Allocator())
+      : concurrent_vector(alloc) {
+    grow_by(count);
+  }
+  concurrent_vector(std::initializer_list<T> ilist,
+                    const Allocator &alloc = Allocator())
+      : concurrent_vector(alloc) {
+    reserve(ilist.size());
+    for (const auto &value : ilist) {
+      push_back(value);
+    }
+  }
+
+  // copy ctor, the source must not be growing
+  concurrent_vector(const concurrent_vector &other)
+      : concurrent_vector(alloc_traits::select_on_container_copy_construction(
+            other.m_alloc)) {
+    reserve(other.size());
+    for (const auto &value : other) {
+      push_back(value);
+    }
+  }
+
+  // move ctor
+  concurrent_vector(concurrent_vector &&other) noexcept
+      : m_alloc{std::move(other.m_alloc)} {
+    swap(other);
+  }
+
+  // dtor
+  ~concurrent_vector() {
+    destroy_all();
+    release();
+  }
+
+  concurrent_vector &operator=(const concurrent_vector &other) {
+    if (this != &other) {
+      concurrent_vector temp(other);
+      swap(temp);
+    }
+    return *this;
+  }
+
+  concurrent_vector &operator=(concurrent_vector &&other) noexcept {
+    if (this != &other) {
+      concurrent_vector temp(std::move(other));
+      swap(temp);
+    }
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return m_alloc; }
+
+  // element access
+  reference operator[](size_type pos) noexcept { return *slot(pos); }
+  const_reference operator[](size_type pos) const noexcept {
+    return *slot(pos);
+  }
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::concurrent_vector::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::concurrent_vector::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+
+  // iterators, over the slots claimed when begin/end is called
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept { return iterator(this, size()); }
+  const_iterator end() const noexcept { return const_iterator(this, size()); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  [[nodiscard]] size_type size() const noexcept {
+    return m_size.load(std::memory_order_acquire);
+  }
+  [[nodiscard]] size_type max_size() const noexcept {
+    return std::min(alloc_traits::max_size(m_alloc),
+                    segment_begin(max_segments - 1));
+  }
+  // slots covered by allocated segments, counting from the front
+  [[nodiscard]] size_type capacity() const noexcept {
+    size_type seg = 0;
+    while (seg < max_segments &&
+           m_segments[seg].load(std::memory_order_acquire) != nullptr) {
+      ++seg;
+    }
+    return segment_begin(seg);
+  }
+  void reserve(size_type new_cap) {
+    if (new_cap == 0)
+      return;
+    if (new_cap > max_size())
+      throw std::length_error(
+          "my::concurrent_vector::reserve: can't reserve space greater than "
+          "max_size()!");
+    for (size_type seg = 0; seg <= segment_of(new_cap - 1); ++seg) {
+      segment(seg);
+    }
+  }
+
+  // modifiers
+
+  // appends one element and returns an iterator to it
+  template <class... Args> iterator emplace_back(Args &&...args) {
+    auto idx = m_size.fetch_add(1, std::memory_order_acq_rel);
+    construct_range(idx, 1, [&](pointer p) {
+      alloc_traits::construct(m_alloc, p, std::forward<Args>(args)...);
+    });
+    return iterator(this, idx);
+  }
+  iterator push_back(const T &value) { return emplace_back(value); }
+  iterator push_back(T &&value) { return emplace_back(std::move(value)); }
+
+  // appends count value-initialized elements, or copies of value, as one
+  // contiguous run of indices; returns an iterator to the first
+  iterator grow_by(size_type count) {
+    auto idx = m_size.fetch_add(count, std::memory_order_acq_rel);
+    construct_range(idx, count,
+                    [&](pointer p) { alloc_traits::construct(m_alloc, p); });
+    return iterator(this, idx);
+  }
+  iterator grow_by(size_type count, const T &value) {
+    auto idx = m_size.fetch_add(count, std::memory_order_acq_rel);
+    construct_range(idx, count, [&](pointer p) {
+      alloc_traits::construct(m_alloc, p, value);
+    });
+    return iterator(this, idx);
+  }
+
+  // destroys all elements, keeping the segments
+  void clear() noexcept { destroy_all(); }
+
+  void swap(concurrent_vector &other) noexcept {
+    if (this != &other) {
+      if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, other.m_alloc);
+      }
+      for (size_type seg = 0; seg < max_segments; ++seg) {
+        auto *p = m_segments[seg].load(std::memory_order_relaxed);
+        m_segments[seg].store(
+            other.m_segments[seg].load(std::memory_order_relaxed),
+            std::memory_order_relaxed);
+        other.m_segments[seg].store(p, std::memory_order_relaxed);
+      }
+      auto n = m_size.load(std::memory_order_relaxed);
+      m_size.store(other.m_size.load(std::memory_order_relaxed),
+                   std::memory_order_relaxed);
+      other.m_size.store(n, std::memory_order_relaxed);
+    }
+  }
+};
+} // namespace my
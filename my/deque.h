@@ -0,0 +1,449 @@
+#pragma once
+#include "allocator.h"
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Double-ended queue made of fixed-size blocks plus a map of block pointers.
+// Pushing at either end constructs into the end block, or adds one block and
+// at worst reallocates the map, which copies block pointers only: elements
+// never move, so references (not iterators) stay valid across push_back and
+// push_front, and growth costs O(size / block_size) at most.
+template <class T, class Allocator = allocator<T>> class deque {
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+
+  // elements per block: about 4 KB worth, a power of two and at least 16
+  static constexpr size_type block_size =
+      std::max<size_type>(16, std::bit_floor(4096 / sizeof(T)));
+
+  template <bool Const> class deque_iterator {
+    template <bool> friend class deque_iterator;
+    using container = std::conditional_t<Const, const deque, deque>;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = std::conditional_t<Const, const T *, T *>;
+    using reference = std::conditional_t<Const, const T &, T &>;
+
+    deque_iterator() noexcept = default;
+    deque_iterator(container *c, size_type idx) noexcept : m_c{c}, m_idx{idx} {}
+    template <bool C = Const>
+      requires C
+    deque_iterator(const deque_iterator<false> &other) noexcept
+        : m_c{other.m_c}, m_idx{other.m_idx} {}
+
+    reference operator*() const noexcept { return (*m_c)[m_idx]; }
+    pointer operator->() const noexcept { return &**this; }
+    reference operator[](difference_type n) const noexcept {
+      return *(*this + n);
+    }
+
+    deque_iterator &operator++() noexcept {
+      ++m_idx;
+      return *this;
+    }
+    deque_iterator operator++(int) noexcept {
+      auto tmp = *this;
+      ++m_idx;
+      return tmp;
+    }
+    deque_iterator &operator--() noexcept {
+      --m_idx;
+      return *this;
+    }
+    deque_iterator operator--(int) noexcept {
+      auto tmp = *this;
+      --m_idx;
+      return tmp;
+    }
+    deque_iterator &operator+=(difference_type n) noexcept {
+      m_idx = static_cast<size_type>(static_cast<difference_type>(m_idx) + n);
+      return *this;
+    }
+    deque_iterator &operator-=(difference_type n) noexcept {
+      return *this += -n;
+    }
+    friend deque_iterator operator+(deque_iterator it,
+                                    difference_type n) noexcept {
+      return it += n;
+    }
+    friend deque_iterator operator+(difference_type n,
+                                    deque_iterator it) noexcept {
+      return it += n;
+    }
+    friend deque_iterator operator-(deque_iterator it,
+                                    difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const deque_iterator &a,
+                                     const deque_iterator &b) noexcept {
+      return static_cast<difference_type>(a.m_idx) -
+             static_cast<difference_type>(b.m_idx);
+    }
+    friend bool operator==(const deque_iterator &a,
+                           const deque_iterator &b) noexcept {
+      return a.m_idx == b.m_idx;
+    }
+    friend auto operator<=>(const deque_iterator &a,
+                            const deque_iterator &b) noexcept {
+      return a.m_idx <=> b.m_idx;
+    }
+
+  private:
+    container *m_c = nullptr;
+    size_type m_idx = 0;
+  };
+
+  using iterator = deque_iterator<false>;
+  using const_iterator = deque_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  using alloc_traits = std::allocator_traits<allocator_type>;
+  using map_allocator =
+      typename alloc_traits::template rebind_alloc<pointer>;
+  using map_traits = std::allocator_traits<map_allocator>;
+
+  static constexpr size_type block_shift = std::countr_zero(block_size);
+  static constexpr size_type min_map_size = 8;
+
+  // the slot of position pos, counted from the start of the first block
+  pointer slot(size_type pos) const noexcept {
+    return m_map[m_map_first + (pos >> block_shift)] +
+           (pos & (block_size - 1));
+  }
+
+  // moves the block pointers so that one more fits at the requested end,
+  // reallocating the map only when it is more than half full
+  void reserve_map_slot(bool at_front) {
+    bool room = at_front ? m_map_first > 0
+                         : m_map_first + m_blocks < m_map_size;
+    if (room)
+      return;
+
+    if (2 * (m_blocks + 1) <= m_map_size) {
+      auto new_first = (m_map_size - m_blocks) / 2;
+      auto *first = m_map + m_map_first;
+      if (new_first < m_map_first) {
+        std::copy(first, first + m_blocks, m_map + new_first);
+      } else {
+        std::copy_backward(first, first + m_blocks,
+                           m_map + new_first + m_blocks);
+      }
+      m_map_first = new_first;
+      return;
+    }
+
+    map_allocator map_alloc(m_alloc);
+    auto new_size = std::max(min_map_size, 2 * m_map_size);
+    auto *new_map = map_traits::allocate(map_alloc, new_size);
+    auto new_first = (new_size - m_blocks) / 2;
+    std::copy(m_map + m_map_first, m_map + m_map_first + m_blocks,
+              new_map + new_first);
+    if (m_map != nullptr)
+      map_traits::deallocate(map_alloc, m_map, m_map_size);
+    m_map = new_map;
+    m_map_size = new_size;
+    m_map_first = new_first;
+  }
+
+  void add_block_back() {
+    reserve_map_slot(false);
+    m_map[m_map_first + m_blocks] =
+        alloc_traits::allocate(m_alloc, block_size);
+    ++m_blocks;
+  }
+
+  void add_block_front() {
+    reserve_map_slot(true);
+    m_map[m_map_first - 1] = alloc_traits::allocate(m_alloc, block_size);
+    --m_map_first;
+    ++m_blocks;
+    m_start += block_size;
+  }
+
+  void free_block_back() noexcept {
+    --m_blocks;
+    alloc_traits::deallocate(m_alloc, m_map[m_map_first + m_blocks],
+                             block_size);
+  }
+
+  void free_block_front() noexcept {
+    alloc_traits::deallocate(m_alloc, m_map[m_map_first], block_size);
+    ++m_map_first;
+    --m_blocks;
+    m_start -= block_size;
+  }
+
+  void destroy_all() noexcept {
+    if constexpr (!std::is_trivially_destructible_v<T>) {
+      for (size_type i = 0; i < m_size; ++i) {
+        alloc_traits::destroy(m_alloc, slot(m_start + i));
+      }
+    }
+    m_size = 0;
+  }
+
+  pointer *m_map = nullptr;
+  size_type m_map_size = 0;  // slots in m_map
+  size_type m_map_first = 0; // slot of the first block
+  size_type m_blocks = 0;    // allocated blocks, contiguous in the map
+  size_type m_start = 0;     // position of the front element in the blocks
+  size_type m_size = 0;
+  [[no_unique_address]] allocator_type m_alloc;
+
+public:
+  // ctor
+  deque() noexcept(noexcept(Allocator())) : deque(Allocator()) {}
+  explicit deque(const Allocator &alloc) noexcept : m_alloc{alloc} {}
+  explicit deque(size_type count, const Allocator &alloc = Allocator())
+      : deque(alloc) {
+    resize(count);
+  }
+  deque(size_type count, const T &value, const Allocator &alloc = Allocator())
+      : deque(alloc) {
+    resize(count, value);
+  }
+  template <std::input_iterator InputIt>
+  deque(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+      : deque(alloc) {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+  deque(std::initializer_list<T> ilist, const Allocator &alloc = Allocator())
+      : deque(ilist.begin(), ilist.end(), alloc) {}
+
+  // copy ctor
+  deque(const deque &other)
+      : deque(other.begin(), other.end(),
+              alloc_traits::select_on_container_copy_construction(
+                  other.m_alloc)) {}
+
+  // move ctor
+  deque(deque &&other) noexcept
+      : m_map{std::exchange(other.m_map, nullptr)},
+        m_map_size{std::exchange(other.m_map_size, 0)},
+        m_map_first{std::exchange(other.m_map_first, 0)},
+        m_blocks{std::exchange(other.m_blocks, 0)},
+        m_start{std::exchange(other.m_start, 0)},
+        m_size{std::exchange(other.m_size, 0)},
+        m_alloc{std::move(other.m_alloc)} {}
+
+  // dtor
+  ~deque() {
+    clear();
+    if (m_map != nullptr) {
+      map_allocator map_alloc(m_alloc);
+      map_traits::deallocate(map_alloc, m_map, m_map_size);
+    }
+  }
+
+  // the copy is built with the allocator this deque ends up with, so the
+  // swap never leaves blocks with an allocator that didn't make them
+  deque &operator=(const deque &other) {
+    if (this != &other) {
+      constexpr bool propagate =
+          alloc_traits::propagate_on_container_copy_assignment::value;
+      deque temp(other.begin(), other.end(),
+                 propagate ? other.m_alloc : m_alloc);
+      swap(temp);
+      if constexpr (propagate &&
+                    !alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, temp.m_alloc);
+      }
+    }
+    return *this;
+  }
+
+  deque &operator=(deque &&other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
+    if (this != &other) {
+      constexpr bool propagate =
+          alloc_traits::propagate_on_container_move_assignment::value;
+      if constexpr (!propagate && !alloc_traits::is_always_equal::value) {
+        // blocks of an unequal allocator can't be adopted, move elementwise
+        if (m_alloc != other.m_alloc) {
+          deque temp(std::make_move_iterator(other.begin()),
+                     std::make_move_iterator(other.end()), m_alloc);
+          swap(temp);
+          other.clear();
+          return *this;
+        }
+      }
+      deque temp(std::move(other));
+      swap(temp);
+      if constexpr (propagate &&
+                    !alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, temp.m_alloc);
+      }
+    }
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return m_alloc; }
+
+  // element access
+  reference operator[](size_type pos) noexcept { return *slot(m_start + pos); }
+  const_reference operator[](size_type pos) const noexcept {
+    return *slot(m_start + pos);
+  }
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::deque::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::deque::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[m_size - 1]; }
+  const_reference back() const noexcept { return (*this)[m_size - 1]; }
+
+  // iterators
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept { return iterator(this, m_size); }
+  const_iterator end() const noexcept { return const_iterator(this, m_size); }
+  const_iterator cend() const noexcept { return end(); }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+  [[nodiscard]] size_type max_size() const noexcept {
+    return alloc_traits::max_size(m_alloc);
+  }
+
+  // modifiers
+  void clear() noexcept {
+    destroy_all();
+    while (m_blocks != 0) {
+      free_block_back();
+    }
+    m_start = 0;
+    m_map_first = m_map_size / 2;
+  }
+
+  template <class... Args> reference emplace_back(Args &&...args) {
+    auto pos = m_start + m_size;
+    if (pos == m_blocks * block_size)
+      add_block_back();
+    auto *p = slot(pos);
+    alloc_traits::construct(m_alloc, p, std::forward<Args>(args)...);
+    ++m_size;
+    return *p;
+  }
+
+  template <class... Args> reference emplace_front(Args &&...args) {
+    if (m_start == 0)
+      add_block_front();
+    auto *p = slot(m_start - 1);
+    alloc_traits::construct(m_alloc, p, std::forward<Args>(args)...);
+    --m_start;
+    ++m_size;
+    return *p;
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+  void push_front(const T &value) { emplace_front(value); }
+  void push_front(T &&value) { emplace_front(std::move(value)); }
+
+  // both pops release a block as soon as it is empty, keeping the last one
+  void pop_back() noexcept {
+    --m_size;
+    alloc_traits::destroy(m_alloc, slot(m_start + m_size));
+    if (m_blocks > 1 && m_start + m_size <= (m_blocks - 1) * block_size)
+      free_block_back();
+  }
+
+  void pop_front() noexcept {
+    alloc_traits::destroy(m_alloc, slot(m_start));
+    ++m_start;
+    --m_size;
+    if (m_blocks > 1 && m_start >= block_size)
+      free_block_front();
+  }
+
+  void resize(size_type count) {
+    while (m_size > count) {
+      pop_back();
+    }
+    while (m_size < count) {
+      emplace_back();
+    }
+  }
+
+  void resize(size_type count, const value_type &value) {
+    while (m_size > count) {
+      pop_back();
+    }
+    while (m_size < count) {
+      emplace_back(value);
+    }
+  }
+
+  void swap(deque &other) noexcept {
+    if (this != &other) {
+      if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, other.m_alloc);
+      }
+      std::swap(m_map, other.m_map);
+      std::swap(m_map_size, other.m_map_size);
+      std::swap(m_map_first, other.m_map_first);
+      std::swap(m_blocks, other.m_blocks);
+      std::swap(m_start, other.m_start);
+      std::swap(m_size, other.m_size);
+    }
+  }
+};
+
+// Non-member functions
+template <class T, class Alloc>
+auto operator<=>(const deque<T, Alloc> &lhs, const deque<T, Alloc> &rhs) {
+  return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(),
+                                                rhs.begin(), rhs.end());
+}
+
+template <class T, class Alloc>
+bool operator==(const deque<T, Alloc> &lhs, const deque<T, Alloc> &rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+} // namespace my
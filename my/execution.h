@@ -0,0 +1,199 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace my {
+
+namespace execution {
+// tag asking a container operation to spread its work over all cores
+struct parallel_policy {
+  explicit parallel_policy() = default;
+};
+inline constexpr parallel_policy par{};
+} // namespace execution
+
+namespace detail {
+
+// A fixed set of worker threads that run one batch of indexed tasks at a
+// time. The submitting thread works on the batch too, so a pool without
+// workers degenerates into a plain loop.
+class thread_pool {
+  struct batch {
+    batch(void (*invoke)(void *, std::size_t), void *task, std::size_t count)
+        : invoke{invoke}, task{task}, count{count} {}
+
+    void (*invoke)(void *, std::size_t);
+    void *task;
+    std::size_t count;
+    std::atomic<std::size_t> next{0};
+    std::size_t attached = 0; // workers inside work(), guarded by m_mutex
+    std::exception_ptr error; // first failure, guarded by m_mutex
+  };
+
+public:
+  explicit thread_pool(std::size_t workers) {
+    m_workers.reserve(workers);
+    for (std::size_t i = 0; i < workers; ++i) {
+      m_workers.emplace_back([this] { worker_loop(); });
+    }
+  }
+
+  thread_pool(const thread_pool &) = delete;
+  thread_pool &operator=(const thread_pool &) = delete;
+
+  ~thread_pool() {
+    {
+      std::lock_guard lock(m_mutex);
+      m_stop = true;
+    }
+    m_wake.notify_all();
+    for (auto &t : m_workers) {
+      t.join();
+    }
+  }
+
+  static thread_pool &shared() {
+    static thread_pool pool(
+        std::max(1u, std::thread::hardware_concurrency()) - 1);
+    return pool;
+  }
+
+  [[nodiscard]] std::size_t concurrency() const noexcept {
+    return m_workers.size() + 1;
+  }
+
+  // calls task(i) for every i in [0, count) and returns once all calls are
+  // done. Once a call throws no new ones are started, and the first
+  // exception is rethrown here. Calls from inside a task run serially.
+  template <class Task> void run(std::size_t count, Task &task) {
+    if (t_inside || m_workers.empty() || count <= 1) {
+      for (std::size_t i = 0; i < count; ++i) {
+        task(i);
+      }
+      return;
+    }
+
+    std::lock_guard submit(m_submit);
+    batch b{[](void *t, std::size_t i) { (*static_cast<Task *>(t))(i); },
+            &task, count};
+    {
+      std::lock_guard lock(m_mutex);
+      m_batch = &b;
+      ++m_generation;
+    }
+    m_wake.notify_all();
+
+    t_inside = true;
+    work(b);
+    t_inside = false;
+
+    std::unique_lock lock(m_mutex);
+    m_batch = nullptr;
+    m_done.wait(lock, [&] { return b.attached == 0; });
+    if (b.error) {
+      std::rethrow_exception(b.error);
+    }
+  }
+
+private:
+  void work(batch &b) {
+    for (auto i = b.next.fetch_add(1); i < b.count; i = b.next.fetch_add(1)) {
+      try {
+        b.invoke(b.task, i);
+      } catch (...) {
+        std::lock_guard lock(m_mutex);
+        if (!b.error) {
+          b.error = std::current_exception();
+        }
+        b.next.store(b.count);
+      }
+    }
+  }
+
+  void worker_loop() {
+    t_inside = true;
+    std::size_t seen = 0;
+    std::unique_lock lock(m_mutex);
+    while (true) {
+      m_wake.wait(lock, [&] {
+        return m_stop || (m_batch != nullptr && m_generation != seen);
+      });
+      if (m_stop)
+        return;
+      seen = m_generation;
+      auto &b = *m_batch;
+      ++b.attached;
+      lock.unlock();
+      work(b);
+      lock.lock();
+      if (--b.attached == 0) {
+        m_done.notify_all();
+      }
+    }
+  }
+
+  static inline thread_local bool t_inside = false;
+
+  std::vector<std::thread> m_workers;
+  std::mutex m_submit; // one batch at a time
+  std::mutex m_mutex;
+  std::condition_variable m_wake;
+  std::condition_variable m_done;
+  batch *m_batch = nullptr;
+  std::size_t m_generation = 0;
+  bool m_stop = false;
+};
+
+// chunks smaller than this are not worth a thread
+inline constexpr std::size_t PARALLEL_MIN_CHUNK_BYTES = std::size_t{1} << 20;
+
+// Constructs count objects at first in parallel chunks. construct(b, e, off)
+// must build [b, e), the elements at offset off onwards, and clean up after
+// itself if it throws (like the std::uninitialized_* algorithms do). If any
+// chunk fails, the finished ones are destroyed and the exception propagates.
+template <class T, class Construct>
+void parallel_uninitialized(T *first, std::size_t count, Construct construct) {
+  auto &pool = thread_pool::shared();
+  auto min_chunk =
+      std::max<std::size_t>(1, PARALLEL_MIN_CHUNK_BYTES / sizeof(T));
+  auto chunks = std::min(pool.concurrency() * 4,
+                         (count + min_chunk - 1) / min_chunk);
+  if (chunks <= 1) {
+    construct(first, first + count, std::size_t{0});
+    return;
+  }
+
+  auto chunk = (count + chunks - 1) / chunks;
+  auto bounds = [&](std::size_t i) {
+    return std::pair{std::min(count, i * chunk),
+                     std::min(count, (i + 1) * chunk)};
+  };
+  // each flag is written by one task and read after run() has joined
+  auto done = std::make_unique<bool[]>(chunks);
+  auto task = [&](std::size_t i) {
+    auto [b, e] = bounds(i);
+    construct(first + b, first + e, b);
+    done[i] = true;
+  };
+
+  try {
+    pool.run(chunks, task);
+  } catch (...) {
+    for (std::size_t i = 0; i < chunks; ++i) {
+      if (done[i]) {
+        auto [b, e] = bounds(i);
+        std::destroy(first + b, first + e);
+      }
+    }
+    throw;
+  }
+}
+} // namespace detail
+} // namespace my
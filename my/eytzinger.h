@@ -0,0 +1,73 @@
+#pragma once
+#include "vector.h"
+#include <algorithm>
+#include <bit>
+#include <cstddef>
+#include <functional>
+
+namespace my::detail {
+
+// Copy of a sorted key array in Eytzinger (BFS) order: the root at slot 1,
+// the children of slot k at 2k and 2k + 1. The first levels of every search
+// share a few cache lines, and the slots a search can visit four levels down
+// are adjacent, so they can be prefetched while the current level is
+// compared. rank[k] maps a slot back to the position in the sorted array.
+template <class Key, class Compare = std::less<Key>> class eytzinger_index {
+public:
+  using size_type = std::size_t;
+
+  eytzinger_index() = default;
+
+  void build(const Key *sorted, size_type n) {
+    clear();
+    if (n == 0)
+      return;
+    // slot 0 is never searched, it only keeps the tree 1-based
+    m_keys.resize(n + 1, sorted[0]);
+    m_rank.resize(n + 1);
+    size_type next = 0;
+    fill(sorted, next, 1);
+  }
+
+  void clear() noexcept {
+    m_keys.clear();
+    m_rank.clear();
+  }
+
+  [[nodiscard]] bool empty() const noexcept { return m_keys.empty(); }
+
+  // position in the sorted array of the first key not less than x, or n
+  template <class K>
+  [[nodiscard]] size_type lower_bound(const K &x, const Compare &comp) const {
+    if (m_keys.empty())
+      return 0;
+    auto n = m_keys.size() - 1;
+    const Key *keys = m_keys.data();
+    size_type k = 1;
+    while (k <= n) {
+#if defined(__GNUC__)
+      // four levels down: the 16 possible descendants are adjacent
+      __builtin_prefetch(keys + std::min(k * 16, n));
+#endif
+      k = 2 * k + static_cast<size_type>(comp(keys[k], x));
+    }
+    // undo the right turns taken after the last left turn
+    k >>= std::countr_one(k) + 1;
+    return k == 0 ? n : m_rank[k];
+  }
+
+private:
+  // in-order walk of the implicit tree hands out the sorted keys in order
+  void fill(const Key *sorted, size_type &next, size_type k) {
+    if (k >= m_keys.size())
+      return;
+    fill(sorted, next, 2 * k);
+    m_keys[k] = sorted[next];
+    m_rank[k] = next++;
+    fill(sorted, next, 2 * k + 1);
+  }
+
+  vector<Key> m_keys;
+  vector<size_type> m_rank;
+};
+} // namespace my::detail
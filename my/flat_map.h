@@ -0,0 +1,549 @@
+#pragma once
+#include "eytzinger.h"
+#include "flat_set.h"
+#include "vector.h"
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <numeric>
+#include <stdexcept>
+#include <tuple>
+#include <utility>
+
+namespace my {
+
+template <class Key, class T, class Compare> class flat_map;
+
+namespace detail {
+// positions into keys, in stably sorted order, of the first of each group of
+// equivalent keys
+template <class Key, class Compare>
+vector<std::size_t> sorted_unique_order(const vector<Key> &keys,
+                                        const Compare &comp) {
+  vector<std::size_t> order(keys.size());
+  std::iota(order.begin(), order.end(), std::size_t{0});
+  std::stable_sort(order.begin(), order.end(),
+                   [&](std::size_t a, std::size_t b) {
+                     return comp(keys[a], keys[b]);
+                   });
+  order.erase(std::unique(order.begin(), order.end(),
+                          [&](std::size_t a, std::size_t b) {
+                            return !comp(keys[a], keys[b]);
+                          }),
+              order.end());
+  return order;
+}
+
+// walks the key and value arrays of a flat_map in step; dereferences to a
+// pair of references, so it is only an input iterator to legacy algorithms
+template <class Key, class V> class flat_map_iterator {
+public:
+  using iterator_concept = std::random_access_iterator_tag;
+  using iterator_category = std::input_iterator_tag;
+  using value_type = std::pair<Key, std::remove_const_t<V>>;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::pair<const Key &, V &>;
+
+  struct pointer {
+    reference ref;
+    reference *operator->() noexcept { return &ref; }
+  };
+
+  flat_map_iterator() = default;
+  flat_map_iterator(const Key *key, V *value) noexcept
+      : m_key{key}, m_value{value} {}
+
+  // iterator to const_iterator
+  template <class U>
+    requires(std::is_const_v<V> && std::is_same_v<const U, V>)
+  flat_map_iterator(const flat_map_iterator<Key, U> &other) noexcept
+      : m_key{other.m_key}, m_value{other.m_value} {}
+
+  reference operator*() const noexcept { return {*m_key, *m_value}; }
+  pointer operator->() const noexcept { return {**this}; }
+  reference operator[](difference_type n) const noexcept {
+    return {m_key[n], m_value[n]};
+  }
+
+  flat_map_iterator &operator++() noexcept {
+    ++m_key;
+    ++m_value;
+    return *this;
+  }
+  flat_map_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++*this;
+    return tmp;
+  }
+  flat_map_iterator &operator--() noexcept {
+    --m_key;
+    --m_value;
+    return *this;
+  }
+  flat_map_iterator operator--(int) noexcept {
+    auto tmp = *this;
+    --*this;
+    return tmp;
+  }
+  flat_map_iterator &operator+=(difference_type n) noexcept {
+    m_key += n;
+    m_value += n;
+    return *this;
+  }
+  flat_map_iterator &operator-=(difference_type n) noexcept {
+    return *this += -n;
+  }
+
+  friend flat_map_iterator operator+(flat_map_iterator it,
+                                     difference_type n) noexcept {
+    return it += n;
+  }
+  friend flat_map_iterator operator+(difference_type n,
+                                     flat_map_iterator it) noexcept {
+    return it += n;
+  }
+  friend flat_map_iterator operator-(flat_map_iterator it,
+                                     difference_type n) noexcept {
+    return it -= n;
+  }
+  friend difference_type operator-(const flat_map_iterator &lhs,
+                                   const flat_map_iterator &rhs) noexcept {
+    return lhs.m_key - rhs.m_key;
+  }
+  friend bool operator==(const flat_map_iterator &lhs,
+                         const flat_map_iterator &rhs) noexcept {
+    return lhs.m_key == rhs.m_key;
+  }
+  friend auto operator<=>(const flat_map_iterator &lhs,
+                          const flat_map_iterator &rhs) noexcept {
+    return lhs.m_key <=> rhs.m_key;
+  }
+
+private:
+  template <class, class> friend class flat_map_iterator;
+  template <class, class, class> friend class my::flat_map;
+
+  const Key *m_key = nullptr;
+  V *m_value = nullptr;
+};
+} // namespace detail
+
+// Sorted map kept as two parallel my::vectors, one of keys and one of values,
+// so that searches only touch the keys. Lookups are binary searches, or, after
+// optimize_for_reads(), branchless searches over an Eytzinger copy of the
+// keys; any change to the key set drops that copy again, assigning to values
+// does not.
+template <class Key, class T, class Compare = std::less<Key>> class flat_map {
+public:
+  using key_type = Key;
+  using mapped_type = T;
+  using value_type = std::pair<Key, T>;
+  using key_compare = Compare;
+  using reference = std::pair<const Key &, T &>;
+  using const_reference = std::pair<const Key &, const T &>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using iterator = detail::flat_map_iterator<Key, T>;
+  using const_iterator = detail::flat_map_iterator<Key, const T>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+  using key_container_type = vector<Key>;
+  using mapped_container_type = vector<T>;
+
+private:
+  template <class K> size_type lower_index(const K &key) const {
+    if (m_read_optimized) {
+      return m_index.lower_bound(key, m_comp);
+    }
+    return static_cast<size_type>(
+        std::lower_bound(m_keys.begin(), m_keys.end(), key, m_comp) -
+        m_keys.begin());
+  }
+
+  template <class K> bool equivalent_at(size_type i, const K &key) const {
+    return i != m_keys.size() && !m_comp(key, m_keys[i]);
+  }
+
+  void drop_index() noexcept {
+    if (m_read_optimized) {
+      m_index.clear();
+      m_read_optimized = false;
+    }
+  }
+
+  size_type index_of(const_iterator pos) const noexcept {
+    return static_cast<size_type>(pos.m_key - m_keys.data());
+  }
+
+  iterator at_index(size_type i) noexcept {
+    return {m_keys.data() + i, m_values.data() + i};
+  }
+  const_iterator at_index(size_type i) const noexcept {
+    return {m_keys.data() + i, m_values.data() + i};
+  }
+
+  // keeps the first value of each key, in key order, and drops the rest
+  void sort_unique() {
+    auto order = detail::sorted_unique_order(m_keys, m_comp);
+    key_container_type keys;
+    mapped_container_type values;
+    keys.reserve(order.size());
+    values.reserve(order.size());
+    for (auto i : order) {
+      keys.push_back(std::move(m_keys[i]));
+      values.push_back(std::move(m_values[i]));
+    }
+    m_keys = std::move(keys);
+    m_values = std::move(values);
+  }
+
+  template <class K, class... Args>
+  std::pair<iterator, bool> try_emplace_impl(K &&key, Args &&...args) {
+    auto i = lower_index(key);
+    if (equivalent_at(i, key)) {
+      return {at_index(i), false};
+    }
+    drop_index();
+    m_values.emplace(m_values.begin() + i, std::forward<Args>(args)...);
+    try {
+      m_keys.emplace(m_keys.begin() + i, std::forward<K>(key));
+    } catch (...) {
+      m_values.erase(m_values.begin() + i);
+      throw;
+    }
+    return {at_index(i), true};
+  }
+
+  // merges sorted, duplicate-free runs of new keys and their values, skipping
+  // keys already present, in one linear pass into fresh arrays
+  void merge_sorted_run(key_container_type &run_keys,
+                        mapped_container_type &run_values) {
+    key_container_type keys;
+    mapped_container_type values;
+    keys.reserve(m_keys.size() + run_keys.size());
+    values.reserve(m_keys.size() + run_keys.size());
+    size_type i = 0;
+    size_type j = 0;
+    while (i != m_keys.size() || j != run_keys.size()) {
+      bool take_old = j == run_keys.size() ||
+                      (i != m_keys.size() && !m_comp(run_keys[j], m_keys[i]));
+      if (take_old) {
+        if (j != run_keys.size() && !m_comp(m_keys[i], run_keys[j])) {
+          ++j; // already present, the existing value wins
+        }
+        keys.push_back(std::move(m_keys[i]));
+        values.push_back(std::move(m_values[i]));
+        ++i;
+      } else {
+        keys.push_back(std::move(run_keys[j]));
+        values.push_back(std::move(run_values[j]));
+        ++j;
+      }
+    }
+    if (keys.size() != m_keys.size()) {
+      drop_index();
+    }
+    m_keys = std::move(keys);
+    m_values = std::move(values);
+  }
+
+  template <class InputIt>
+  void split(InputIt first, InputIt last, key_container_type &keys,
+             mapped_container_type &values) {
+    for (; first != last; ++first) {
+      auto &&pair = *first;
+      keys.emplace_back(std::get<0>(std::forward<decltype(pair)>(pair)));
+      values.emplace_back(std::get<1>(std::forward<decltype(pair)>(pair)));
+    }
+  }
+
+  key_container_type m_keys;
+  mapped_container_type m_values;
+  [[no_unique_address]] Compare m_comp;
+  detail::eytzinger_index<Key, Compare> m_index;
+  bool m_read_optimized = false;
+
+public:
+  // ctor
+  flat_map() = default;
+  explicit flat_map(const Compare &comp) : m_comp{comp} {}
+
+  // bulk construction from unsorted keys and their values: one sort of the
+  // positions, one pass keeping the first value of each key
+  flat_map(key_container_type keys, mapped_container_type values,
+           const Compare &comp = Compare())
+      : m_keys{std::move(keys)}, m_values{std::move(values)}, m_comp{comp} {
+    if (m_keys.size() != m_values.size()) {
+      throw std::invalid_argument(
+          "my::flat_map: keys and values differ in size");
+    }
+    sort_unique();
+  }
+
+  flat_map(sorted_unique_t, key_container_type keys,
+           mapped_container_type values, const Compare &comp = Compare())
+      : m_keys{std::move(keys)}, m_values{std::move(values)}, m_comp{comp} {
+    if (m_keys.size() != m_values.size()) {
+      throw std::invalid_argument(
+          "my::flat_map: keys and values differ in size");
+    }
+    assert(std::adjacent_find(m_keys.begin(), m_keys.end(),
+                              [this](const Key &a, const Key &b) {
+                                return !m_comp(a, b);
+                              }) == m_keys.end());
+  }
+
+  template <std::input_iterator InputIt>
+  flat_map(InputIt first, InputIt last, const Compare &comp = Compare())
+      : m_comp{comp} {
+    split(first, last, m_keys, m_values);
+    sort_unique();
+  }
+
+  flat_map(std::initializer_list<value_type> ilist,
+           const Compare &comp = Compare())
+      : flat_map(ilist.begin(), ilist.end(), comp) {}
+
+  // iterators
+  iterator begin() noexcept { return at_index(0); }
+  const_iterator begin() const noexcept { return at_index(0); }
+  const_iterator cbegin() const noexcept { return at_index(0); }
+  iterator end() noexcept { return at_index(size()); }
+  const_iterator end() const noexcept { return at_index(size()); }
+  const_iterator cend() const noexcept { return at_index(size()); }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return m_keys.empty(); }
+  [[nodiscard]] size_type size() const noexcept { return m_keys.size(); }
+  [[nodiscard]] size_type max_size() const noexcept {
+    return std::min(m_keys.max_size(), m_values.max_size());
+  }
+  void reserve(size_type n) {
+    m_keys.reserve(n);
+    m_values.reserve(n);
+  }
+
+  // the sorted keys and the values in the same order, each contiguous
+  [[nodiscard]] const key_container_type &keys() const noexcept {
+    return m_keys;
+  }
+  [[nodiscard]] const mapped_container_type &values() const noexcept {
+    return m_values;
+  }
+
+  // Builds the Eytzinger copy of the keys that lookups use from now on, until
+  // a key is added or removed.
+  void optimize_for_reads() {
+    m_index.build(m_keys.data(), m_keys.size());
+    m_read_optimized = true;
+  }
+  [[nodiscard]] bool read_optimized() const noexcept {
+    return m_read_optimized;
+  }
+
+  // element access
+  T &operator[](const Key &key) { return try_emplace(key).first->second; }
+  T &operator[](Key &&key) {
+    return try_emplace(std::move(key)).first->second;
+  }
+
+  template <class K = Key> T &at(const K &key) {
+    auto i = lower_index(key);
+    if (!equivalent_at(i, key)) {
+      throw std::out_of_range("my::flat_map::at: key not found");
+    }
+    return m_values[i];
+  }
+
+  template <class K = Key> const T &at(const K &key) const {
+    auto i = lower_index(key);
+    if (!equivalent_at(i, key)) {
+      throw std::out_of_range("my::flat_map::at: key not found");
+    }
+    return m_values[i];
+  }
+
+  // modifiers
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(const Key &key, Args &&...args) {
+    return try_emplace_impl(key, std::forward<Args>(args)...);
+  }
+  template <class... Args>
+  std::pair<iterator, bool> try_emplace(Key &&key, Args &&...args) {
+    return try_emplace_impl(std::move(key), std::forward<Args>(args)...);
+  }
+
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(const Key &key, M &&obj) {
+    auto res = try_emplace(key, std::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = std::forward<M>(obj);
+    }
+    return res;
+  }
+  template <class M>
+  std::pair<iterator, bool> insert_or_assign(Key &&key, M &&obj) {
+    auto res = try_emplace(std::move(key), std::forward<M>(obj));
+    if (!res.second) {
+      res.first->second = std::forward<M>(obj);
+    }
+    return res;
+  }
+
+  template <class... Args> std::pair<iterator, bool> emplace(Args &&...args) {
+    value_type value(std::forward<Args>(args)...);
+    return try_emplace(std::move(value.first), std::move(value.second));
+  }
+
+  std::pair<iterator, bool> insert(const value_type &value) {
+    return try_emplace(value.first, value.second);
+  }
+  std::pair<iterator, bool> insert(value_type &&value) {
+    return try_emplace(std::move(value.first), std::move(value.second));
+  }
+
+  // batched insert: the new pairs are sorted among themselves and merged in
+  // one pass, instead of shifting both arrays once per pair
+  template <std::input_iterator InputIt>
+  void insert(InputIt first, InputIt last) {
+    key_container_type keys;
+    mapped_container_type values;
+    split(first, last, keys, values);
+    auto order = detail::sorted_unique_order(keys, m_comp);
+    key_container_type run_keys;
+    mapped_container_type run_values;
+    run_keys.reserve(order.size());
+    run_values.reserve(order.size());
+    for (auto i : order) {
+      run_keys.push_back(std::move(keys[i]));
+      run_values.push_back(std::move(values[i]));
+    }
+    merge_sorted_run(run_keys, run_values);
+  }
+
+  template <std::input_iterator InputIt>
+  void insert(sorted_unique_t, InputIt first, InputIt last) {
+    key_container_type run_keys;
+    mapped_container_type run_values;
+    split(first, last, run_keys, run_values);
+    merge_sorted_run(run_keys, run_values);
+  }
+
+  void insert(std::initializer_list<value_type> ilist) {
+    insert(ilist.begin(), ilist.end());
+  }
+
+  iterator erase(const_iterator pos) {
+    return erase(pos, std::next(pos));
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto i = index_of(first);
+    auto j = index_of(last);
+    if (i != j) {
+      drop_index();
+      m_keys.erase(m_keys.begin() + i, m_keys.begin() + j);
+      m_values.erase(m_values.begin() + i, m_values.begin() + j);
+    }
+    return at_index(i);
+  }
+
+  size_type erase(const Key &key) {
+    auto i = lower_index(key);
+    if (!equivalent_at(i, key))
+      return 0;
+    erase(at_index(i));
+    return 1;
+  }
+
+  void clear() noexcept {
+    drop_index();
+    m_keys.clear();
+    m_values.clear();
+  }
+
+  void swap(flat_map &other) noexcept {
+    using std::swap;
+    swap(m_keys, other.m_keys);
+    swap(m_values, other.m_values);
+    swap(m_comp, other.m_comp);
+    swap(m_index, other.m_index);
+    swap(m_read_optimized, other.m_read_optimized);
+  }
+
+  // lookup
+  template <class K = Key> iterator find(const K &key) {
+    auto i = lower_index(key);
+    return equivalent_at(i, key) ? at_index(i) : end();
+  }
+  template <class K = Key> const_iterator find(const K &key) const {
+    auto i = lower_index(key);
+    return equivalent_at(i, key) ? at_index(i) : end();
+  }
+
+  template <class K = Key> [[nodiscard]] bool contains(const K &key) const {
+    return equivalent_at(lower_index(key), key);
+  }
+
+  template <class K = Key> size_type count(const K &key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  template <class K = Key> iterator lower_bound(const K &key) {
+    return at_index(lower_index(key));
+  }
+  template <class K = Key> const_iterator lower_bound(const K &key) const {
+    return at_index(lower_index(key));
+  }
+
+  template <class K = Key> iterator upper_bound(const K &key) {
+    auto i = lower_index(key);
+    return at_index(equivalent_at(i, key) ? i + 1 : i);
+  }
+  template <class K = Key> const_iterator upper_bound(const K &key) const {
+    auto i = lower_index(key);
+    return at_index(equivalent_at(i, key) ? i + 1 : i);
+  }
+
+  template <class K = Key>
+  std::pair<iterator, iterator> equal_range(const K &key) {
+    return {lower_bound(key), upper_bound(key)};
+  }
+  template <class K = Key>
+  std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  [[nodiscard]] key_compare key_comp() const { return m_comp; }
+
+  friend bool operator==(const flat_map &lhs, const flat_map &rhs) {
+    return lhs.m_keys == rhs.m_keys && lhs.m_values == rhs.m_values;
+  }
+
+  friend auto operator<=>(const flat_map &lhs, const flat_map &rhs) {
+    return std::lexicographical_compare_three_way(
+        lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+        [](const_reference a, const_reference b) {
+          return std::tie(a.first, a.second) <=> std::tie(b.first, b.second);
+        });
+  }
+};
+
+template <class Key, class T, class Compare>
+void swap(flat_map<Key, T, Compare> &lhs,
+          flat_map<Key, T, Compare> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace my
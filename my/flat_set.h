@@ -0,0 +1,267 @@
+#pragma once
+#include "eytzinger.h"
+#include "vector.h"
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <utility>
+
+namespace my {
+
+// tag for members taking input that is already sorted and free of duplicates
+struct sorted_unique_t {
+  explicit sorted_unique_t() = default;
+};
+inline constexpr sorted_unique_t sorted_unique{};
+
+namespace detail {
+// sorts [first, last) and drops every element equivalent to an earlier one,
+// keeping the first of each run as std::flat_set does; returns the new end
+template <class It, class Compare>
+It sort_unique(It first, It last, const Compare &comp) {
+  std::stable_sort(first, last, comp);
+  return std::unique(first, last, [&comp](const auto &a, const auto &b) {
+    return !comp(a, b);
+  });
+}
+} // namespace detail
+
+// Sorted set in one contiguous my::vector. Lookups are binary searches over
+// the array, or, after optimize_for_reads(), branchless searches over an
+// Eytzinger copy of it; any insertion or erasure drops that copy again.
+template <class Key, class Compare = std::less<Key>> class flat_set {
+public:
+  using key_type = Key;
+  using value_type = Key;
+  using key_compare = Compare;
+  using value_compare = Compare;
+  using container_type = vector<Key>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = const Key &;
+  using const_reference = const Key &;
+  using iterator = typename container_type::const_iterator;
+  using const_iterator = typename container_type::const_iterator;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  template <class K> size_type lower_index(const K &key) const {
+    if (m_read_optimized) {
+      return m_index.lower_bound(key, m_comp);
+    }
+    return static_cast<size_type>(
+        std::lower_bound(m_keys.begin(), m_keys.end(), key, m_comp) -
+        m_keys.begin());
+  }
+
+  template <class K> bool equivalent_at(size_type i, const K &key) const {
+    return i != m_keys.size() && !m_comp(key, m_keys[i]);
+  }
+
+  void drop_index() noexcept {
+    if (m_read_optimized) {
+      m_index.clear();
+      m_read_optimized = false;
+    }
+  }
+
+  // merges a sorted, duplicate-free run of new keys into m_keys, skipping
+  // the ones already present, in one linear merge
+  void merge_sorted_run(vector<Key> &run) {
+    run.erase(std::remove_if(run.begin(), run.end(),
+                             [this](const Key &k) { return contains(k); }),
+              run.end());
+    if (run.empty())
+      return;
+    drop_index();
+    auto old_size = static_cast<difference_type>(m_keys.size());
+    m_keys.insert(m_keys.end(), std::make_move_iterator(run.begin()),
+                  std::make_move_iterator(run.end()));
+    std::inplace_merge(m_keys.begin(), m_keys.begin() + old_size,
+                       m_keys.end(), m_comp);
+  }
+
+  container_type m_keys;
+  [[no_unique_address]] Compare m_comp;
+  detail::eytzinger_index<Key, Compare> m_index;
+  bool m_read_optimized = false;
+
+public:
+  // ctor
+  flat_set() = default;
+  explicit flat_set(const Compare &comp) : m_comp{comp} {}
+
+  // bulk construction from unsorted keys: one sort, one unique pass
+  explicit flat_set(container_type keys, const Compare &comp = Compare())
+      : m_keys{std::move(keys)}, m_comp{comp} {
+    m_keys.erase(detail::sort_unique(m_keys.begin(), m_keys.end(), m_comp),
+                 m_keys.end());
+  }
+
+  flat_set(sorted_unique_t, container_type keys,
+           const Compare &comp = Compare())
+      : m_keys{std::move(keys)}, m_comp{comp} {
+    assert(std::adjacent_find(m_keys.begin(), m_keys.end(),
+                              [this](const Key &a, const Key &b) {
+                                return !m_comp(a, b);
+                              }) == m_keys.end());
+  }
+
+  template <std::input_iterator InputIt>
+  flat_set(InputIt first, InputIt last, const Compare &comp = Compare())
+      : flat_set(container_type(std::from_range, stdr::subrange(first, last)),
+                 comp) {}
+
+  flat_set(std::initializer_list<Key> ilist, const Compare &comp = Compare())
+      : flat_set(ilist.begin(), ilist.end(), comp) {}
+
+  // iterators
+  const_iterator begin() const noexcept { return m_keys.begin(); }
+  const_iterator cbegin() const noexcept { return m_keys.begin(); }
+  const_iterator end() const noexcept { return m_keys.end(); }
+  const_iterator cend() const noexcept { return m_keys.end(); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return m_keys.empty(); }
+  [[nodiscard]] size_type size() const noexcept { return m_keys.size(); }
+  [[nodiscard]] size_type max_size() const noexcept {
+    return m_keys.max_size();
+  }
+  void reserve(size_type n) { m_keys.reserve(n); }
+
+  // the sorted keys, contiguous
+  [[nodiscard]] const container_type &keys() const noexcept { return m_keys; }
+
+  // Builds the Eytzinger copy of the keys that lookups use from now on, until
+  // the set is modified. Worth it for sets that are built once and then
+  // searched many times.
+  void optimize_for_reads() {
+    m_index.build(m_keys.data(), m_keys.size());
+    m_read_optimized = true;
+  }
+  [[nodiscard]] bool read_optimized() const noexcept {
+    return m_read_optimized;
+  }
+
+  // modifiers
+  template <class... Args> std::pair<iterator, bool> emplace(Args &&...args) {
+    Key key(std::forward<Args>(args)...);
+    auto i = lower_index(key);
+    if (equivalent_at(i, key)) {
+      return {begin() + i, false};
+    }
+    drop_index();
+    m_keys.insert(m_keys.begin() + i, std::move(key));
+    return {begin() + i, true};
+  }
+
+  std::pair<iterator, bool> insert(const Key &key) { return emplace(key); }
+  std::pair<iterator, bool> insert(Key &&key) {
+    return emplace(std::move(key));
+  }
+
+  // batched insert: the new keys are sorted among themselves and merged in
+  // one pass, instead of shifting the array once per key
+  template <std::input_iterator InputIt>
+  void insert(InputIt first, InputIt last) {
+    vector<Key> run(std::from_range, stdr::subrange(first, last));
+    run.erase(detail::sort_unique(run.begin(), run.end(), m_comp), run.end());
+    merge_sorted_run(run);
+  }
+
+  template <std::input_iterator InputIt>
+  void insert(sorted_unique_t, InputIt first, InputIt last) {
+    vector<Key> run(std::from_range, stdr::subrange(first, last));
+    merge_sorted_run(run);
+  }
+
+  void insert(std::initializer_list<Key> ilist) {
+    insert(ilist.begin(), ilist.end());
+  }
+
+  iterator erase(const_iterator pos) {
+    drop_index();
+    return m_keys.erase(pos);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    drop_index();
+    return m_keys.erase(first, last);
+  }
+
+  size_type erase(const Key &key) {
+    auto i = lower_index(key);
+    if (!equivalent_at(i, key))
+      return 0;
+    erase(begin() + i);
+    return 1;
+  }
+
+  void clear() noexcept {
+    drop_index();
+    m_keys.clear();
+  }
+
+  void swap(flat_set &other) noexcept {
+    using std::swap;
+    swap(m_keys, other.m_keys);
+    swap(m_comp, other.m_comp);
+    swap(m_index, other.m_index);
+    swap(m_read_optimized, other.m_read_optimized);
+  }
+
+  // lookup
+  template <class K = Key> const_iterator find(const K &key) const {
+    auto i = lower_index(key);
+    return equivalent_at(i, key) ? begin() + i : end();
+  }
+
+  template <class K = Key> [[nodiscard]] bool contains(const K &key) const {
+    return equivalent_at(lower_index(key), key);
+  }
+
+  template <class K = Key> size_type count(const K &key) const {
+    return contains(key) ? 1 : 0;
+  }
+
+  template <class K = Key> const_iterator lower_bound(const K &key) const {
+    return begin() + lower_index(key);
+  }
+
+  template <class K = Key> const_iterator upper_bound(const K &key) const {
+    auto it = lower_bound(key);
+    return it != end() && !m_comp(key, *it) ? it + 1 : it;
+  }
+
+  template <class K = Key>
+  std::pair<const_iterator, const_iterator> equal_range(const K &key) const {
+    return {lower_bound(key), upper_bound(key)};
+  }
+
+  [[nodiscard]] key_compare key_comp() const { return m_comp; }
+
+  friend bool operator==(const flat_set &lhs, const flat_set &rhs) {
+    return lhs.m_keys == rhs.m_keys;
+  }
+
+  friend auto operator<=>(const flat_set &lhs, const flat_set &rhs) {
+    return lhs.m_keys <=> rhs.m_keys;
+  }
+};
+
+template <class Key, class Compare>
+void swap(flat_set<Key, Compare> &lhs, flat_set<Key, Compare> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace my
@@ -0,0 +1,131 @@
+#pragma once
+#include "allocator.h"
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include <sys/mman.h>
+
+namespace my {
+
+// Serves large blocks from 2 MB aligned anonymous mappings and asks the
+// kernel to back them with transparent huge pages, so that random access into
+// big tables needs one TLB entry per 2 MB instead of per 4 KB. If the kernel
+// refuses (THP disabled, no madvise support) the mapping simply stays on
+// normal pages. Small blocks go to ::operator new.
+class huge_page_resource {
+public:
+  static constexpr std::size_t huge_page_size = std::size_t{2} << 20;
+
+  // blocks of at least this many bytes are mapped
+  static constexpr std::size_t threshold = huge_page_size;
+
+  // bytes actually handed out for a request of the given size
+  static constexpr std::size_t usable_size(std::size_t bytes) noexcept {
+    if (bytes < threshold)
+      return bytes;
+    return (bytes + huge_page_size - 1) / huge_page_size * huge_page_size;
+  }
+
+  void *allocate(std::size_t bytes,
+                 std::size_t alignment = alignof(std::max_align_t)) {
+    if (bytes < threshold)
+      return ::operator new(bytes, std::align_val_t{alignment});
+
+    auto length = usable_size(bytes);
+    void *p = map_aligned(length);
+#if defined(MADV_HUGEPAGE)
+    // advisory only: failure leaves the block on normal pages
+    ::madvise(p, length, MADV_HUGEPAGE);
+#endif
+    return p;
+  }
+
+  void deallocate(void *p, std::size_t bytes,
+                  std::size_t alignment = alignof(std::max_align_t)) noexcept {
+    if (p == nullptr)
+      return;
+    if (bytes < threshold) {
+      ::operator delete(p, std::align_val_t{alignment});
+      return;
+    }
+    ::munmap(p, usable_size(bytes));
+  }
+
+  bool operator==(const huge_page_resource &) const noexcept { return true; }
+
+private:
+  // over-reserves by one huge page and trims both ends so the block starts
+  // on a huge page boundary, which THP needs to use a huge page for it
+  static void *map_aligned(std::size_t length) {
+    auto reserved = length + huge_page_size;
+    void *raw = ::mmap(nullptr, reserved, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) {
+      // no room for the slack, take whatever alignment we get
+      raw = ::mmap(nullptr, length, PROT_READ | PROT_WRITE,
+                   MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+      if (raw == MAP_FAILED)
+        throw std::bad_alloc();
+      return raw;
+    }
+
+    auto addr = reinterpret_cast<std::uintptr_t>(raw);
+    auto aligned =
+        (addr + huge_page_size - 1) / huge_page_size * huge_page_size;
+    auto head = aligned - addr;
+    auto tail = reserved - head - length;
+    if (head != 0)
+      ::munmap(raw, head);
+    if (tail != 0)
+      ::munmap(reinterpret_cast<void *>(aligned + length), tail);
+    return reinterpret_cast<void *>(aligned);
+  }
+};
+
+// typed front end of huge_page_resource, usable as the allocator of any
+// container: my::vector<T, my::huge_page_allocator<T>>
+template <class T> struct huge_page_allocator {
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  constexpr huge_page_allocator() noexcept = default;
+  template <class U>
+  constexpr huge_page_allocator(const huge_page_allocator<U> &) noexcept {}
+
+  [[nodiscard]] pointer allocate(size_type n) {
+    return allocate_at_least(n).ptr;
+  }
+
+  // mapped blocks are rounded up to whole huge pages, report all of it
+  [[nodiscard]] allocation_result<pointer> allocate_at_least(size_type n) {
+    if (n == 0)
+      return {nullptr, 0};
+    if (n > std::numeric_limits<size_type>::max() / sizeof(value_type))
+      throw std::bad_array_new_length();
+
+    auto bytes = n * sizeof(value_type);
+    auto *p = static_cast<pointer>(
+        huge_page_resource{}.allocate(bytes, alignof(value_type)));
+    return {p, huge_page_resource::usable_size(bytes) / sizeof(value_type)};
+  }
+
+  void deallocate(pointer p, size_type n) noexcept {
+    huge_page_resource{}.deallocate(p, n * sizeof(value_type),
+                                    alignof(value_type));
+  }
+
+  template <class U>
+  friend constexpr bool operator==(const huge_page_allocator &,
+                                   const huge_page_allocator<U> &) noexcept {
+    return true;
+  }
+};
+} // namespace my
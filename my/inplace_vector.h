@@ -0,0 +1,428 @@
+#pragma once
+#include "vector.h"
+#include <algorithm>
+#include <cassert>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <new>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+namespace detail {
+// smallest unsigned type that can count to N
+template <std::size_t N>
+using inplace_size_t = std::conditional_t<
+    N <= UINT8_MAX, std::uint8_t,
+    std::conditional_t<N <= UINT16_MAX, std::uint16_t,
+                       std::conditional_t<N <= UINT32_MAX, std::uint32_t,
+                                          std::size_t>>>;
+
+// Element buffer and size of inplace_vector. The elements live in an
+// anonymous union so that none of them is constructed up front. When T is
+// trivially copyable the special members stay defaulted and the whole vector
+// is trivially copyable: a copy is one fixed-size memcpy of the buffer.
+template <class T, std::size_t N, bool = std::is_trivially_copyable_v<T>>
+class inplace_storage {
+protected:
+  union {
+    T m_elems[N];
+  };
+  inplace_size_t<N> m_size = 0;
+
+  inplace_storage() noexcept {}
+};
+
+// other types copy, move and destroy the live elements only
+template <class T, std::size_t N> class inplace_storage<T, N, false> {
+protected:
+  union {
+    T m_elems[N];
+  };
+  inplace_size_t<N> m_size = 0;
+
+  inplace_storage() noexcept {}
+
+  inplace_storage(const inplace_storage &other) {
+    std::uninitialized_copy_n(other.m_elems, other.m_size, m_elems);
+    m_size = other.m_size;
+  }
+
+  inplace_storage(inplace_storage &&other) noexcept(
+      std::is_nothrow_move_constructible_v<T>) {
+    std::uninitialized_move_n(other.m_elems, other.m_size, m_elems);
+    m_size = other.m_size;
+  }
+
+  inplace_storage &operator=(const inplace_storage &other) {
+    if (this != &other) {
+      assign_from(other.m_elems, other.m_size);
+    }
+    return *this;
+  }
+
+  inplace_storage &operator=(inplace_storage &&other) noexcept(
+      std::is_nothrow_move_assignable_v<T> &&
+      std::is_nothrow_move_constructible_v<T>) {
+    if (this != &other) {
+      assign_from(std::make_move_iterator(other.m_elems), other.m_size);
+    }
+    return *this;
+  }
+
+  ~inplace_storage() { std::destroy_n(m_elems, m_size); }
+
+private:
+  // assigns over the common prefix, then constructs or destroys the rest
+  template <class It> void assign_from(It src, std::size_t count) {
+    auto common = std::min<std::size_t>(count, m_size);
+    src = std::ranges::copy_n(src, static_cast<std::ptrdiff_t>(common),
+                              m_elems)
+              .in;
+    if (count > m_size) {
+      std::uninitialized_copy_n(src, count - m_size, m_elems + m_size);
+    } else {
+      std::destroy(m_elems + count, m_elems + m_size);
+    }
+    m_size = static_cast<inplace_size_t<N>>(count);
+  }
+};
+} // namespace detail
+
+// A vector with room for N elements inside the object that never allocates,
+// after C++26's std::inplace_vector. Operations that would exceed N throw
+// std::bad_alloc; the try_ variants report it by returning nullptr instead,
+// and the unchecked_ variants leave it to the caller. Insertion and erasure
+// share the algorithms of my::vector.
+template <class T, std::size_t N>
+class inplace_vector : detail::inplace_storage<T, N> {
+  static_assert(N > 0, "my::inplace_vector: capacity must be non-zero");
+
+  using base = detail::inplace_storage<T, N>;
+  using base::m_elems;
+  using base::m_size;
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  static void ensure_room(size_type count) {
+    if (count > N)
+      throw std::bad_alloc();
+  }
+
+  void set_size(size_type count) noexcept {
+    m_size = static_cast<detail::inplace_size_t<N>>(count);
+  }
+
+public:
+  // ctor
+  inplace_vector() noexcept = default;
+
+  explicit inplace_vector(size_type count) {
+    ensure_room(count);
+    std::uninitialized_value_construct_n(data(), count);
+    set_size(count);
+  }
+
+  inplace_vector(size_type count, const_reference value) {
+    ensure_room(count);
+    std::uninitialized_fill_n(data(), count, value);
+    set_size(count);
+  }
+
+  template <std::input_iterator InputIt>
+  inplace_vector(InputIt first, InputIt last) {
+    insert(end(), first, last);
+  }
+
+  template <container_compatible_range<T> R>
+  inplace_vector(std::from_range_t, R &&rg) {
+    append_range(std::forward<R>(rg));
+  }
+
+  inplace_vector(std::initializer_list<value_type> ilist)
+      : inplace_vector(ilist.begin(), ilist.end()) {}
+
+  inplace_vector &operator=(std::initializer_list<value_type> ilist) {
+    inplace_vector temp(ilist);
+    *this = std::move(temp);
+    return *this;
+  }
+
+  // element access
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::inplace_vector::at: index out of range");
+    }
+    return data()[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::inplace_vector::at: index out of range");
+    }
+    return data()[pos];
+  }
+  reference operator[](size_type pos) { return data()[pos]; }
+  const_reference operator[](size_type pos) const { return data()[pos]; }
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(end() - 1); }
+  const_reference back() const { return *(end() - 1); }
+  pointer data() noexcept { return m_elems; }
+  const_pointer data() const noexcept { return m_elems; }
+
+  // iterators
+  iterator begin() noexcept { return data(); }
+  const_iterator begin() const noexcept { return data(); }
+  const_iterator cbegin() const noexcept { return data(); }
+  iterator end() noexcept { return data() + size(); }
+  const_iterator end() const noexcept { return data() + size(); }
+  const_iterator cend() const noexcept { return data() + size(); }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+  [[nodiscard]] static constexpr size_type max_size() noexcept { return N; }
+  [[nodiscard]] static constexpr size_type capacity() noexcept { return N; }
+  // nothing to allocate, only checks that new_cap fits
+  static void reserve(size_type new_cap) { ensure_room(new_cap); }
+  static void shrink_to_fit() noexcept {}
+
+  void resize(size_type count) {
+    ensure_room(count);
+    if (count < size()) {
+      std::destroy(begin() + count, end());
+    } else {
+      std::uninitialized_value_construct(end(), begin() + count);
+    }
+    set_size(count);
+  }
+
+  void resize(size_type count, const T &value) {
+    ensure_room(count);
+    if (count < size()) {
+      std::destroy(begin() + count, end());
+    } else {
+      std::uninitialized_fill(end(), begin() + count, value);
+    }
+    set_size(count);
+  }
+
+  // modifiers
+  void clear() noexcept {
+    std::destroy(begin(), end());
+    m_size = 0;
+  }
+
+  // the element is constructed in place, so args must not refer to an
+  // element of *this
+  template <class... Args> reference unchecked_emplace_back(Args &&...args) {
+    assert(size() < N);
+    auto *p = std::construct_at(end(), std::forward<Args>(args)...);
+    ++m_size;
+    return *p;
+  }
+
+  // nullptr when full, without constructing anything
+  template <class... Args> pointer try_emplace_back(Args &&...args) {
+    if (size() == N)
+      return nullptr;
+    return std::addressof(unchecked_emplace_back(std::forward<Args>(args)...));
+  }
+
+  template <class... Args> reference emplace_back(Args &&...args) {
+    ensure_room(size() + 1);
+    return unchecked_emplace_back(std::forward<Args>(args)...);
+  }
+
+  void push_back(const_reference value) { emplace_back(value); }
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+  pointer try_push_back(const_reference value) {
+    return try_emplace_back(value);
+  }
+  pointer try_push_back(T &&value) {
+    return try_emplace_back(std::move(value));
+  }
+  reference unchecked_push_back(const_reference value) {
+    return unchecked_emplace_back(value);
+  }
+  reference unchecked_push_back(T &&value) {
+    return unchecked_emplace_back(std::move(value));
+  }
+
+  void pop_back() {
+    if (empty())
+      return;
+    std::destroy_at(end() - 1);
+    --m_size;
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args &&...args) {
+    assert((pos >= cbegin()) && (pos <= cend()));
+    auto idx = static_cast<size_type>(pos - cbegin());
+    ensure_room(size() + 1);
+    // args may refer to elements that are about to move
+    T temp(std::forward<Args>(args)...);
+    detail::emplace_in_place(begin() + idx, end(), std::move(temp));
+    ++m_size;
+    return begin() + idx;
+  }
+
+  iterator insert(const_iterator pos, const_reference value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T &&value) {
+    return emplace(pos, std::move(value));
+  }
+
+  iterator insert(const_iterator pos, size_type count, const T &value) {
+    assert((pos >= cbegin()) && (pos <= cend()));
+    auto idx = static_cast<size_type>(pos - cbegin());
+    ensure_room(size() + count);
+    if (count != 0) {
+      detail::insert_fill_in_place(begin() + idx, end(), count, value);
+      set_size(size() + count);
+    }
+    return begin() + idx;
+  }
+
+  template <std::input_iterator InputIt>
+  iterator insert(const_iterator pos, InputIt first, InputIt last) {
+    // ub if either first or last are iterators into *this
+    return insert_range(pos, stdr::subrange(first, last));
+  }
+
+  iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+  }
+
+  // Sized ranges are checked against the capacity before anything moves;
+  // input ranges are appended one by one and rotated into place.
+  template <container_compatible_range<T> R>
+  iterator insert_range(const_iterator pos, R &&rg) {
+    assert((pos >= cbegin()) && (pos <= cend()));
+    auto idx = static_cast<size_type>(pos - cbegin());
+    if constexpr (stdr::forward_range<R> || stdr::sized_range<R>) {
+      auto count = static_cast<size_type>(stdr::distance(rg));
+      ensure_room(size() + count);
+      if (count != 0) {
+        detail::insert_copy_in_place(begin() + idx, end(), stdr::begin(rg),
+                                     count);
+        set_size(size() + count);
+      }
+    } else {
+      auto old_size = size();
+      for (auto &&e : rg) {
+        emplace_back(std::forward<decltype(e)>(e));
+      }
+      std::rotate(begin() + idx, begin() + old_size, end());
+    }
+    return begin() + idx;
+  }
+
+  template <container_compatible_range<T> R> void append_range(R &&rg) {
+    insert_range(cend(), std::forward<R>(rg));
+  }
+
+  // appends until full and returns the first element of rg left out
+  template <container_compatible_range<T> R>
+  stdr::borrowed_iterator_t<R> try_append_range(R &&rg) {
+    auto first = stdr::begin(rg);
+    auto last = stdr::end(rg);
+    for (; first != last && size() < N; ++first) {
+      unchecked_emplace_back(*first);
+    }
+    if constexpr (stdr::borrowed_range<R>) {
+      return first;
+    } else {
+      return stdr::dangling{};
+    }
+  }
+
+  iterator erase(const_iterator pos) {
+    assert((pos >= cbegin()) && (pos < cend()));
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    assert(first <= last);
+    assert(first >= cbegin() && last <= cend());
+    auto idx = static_cast<size_type>(first - cbegin());
+    auto count = static_cast<size_type>(last - first);
+    if (count != 0) {
+      detail::erase_in_place(begin() + idx, begin() + idx + count, end());
+      set_size(size() - count);
+    }
+    return begin() + idx;
+  }
+
+  void swap(inplace_vector &other) noexcept(
+      std::is_nothrow_swappable_v<T> &&
+      std::is_nothrow_move_constructible_v<T>) {
+    auto &shorter = size() < other.size() ? *this : other;
+    auto &longer = size() < other.size() ? other : *this;
+    auto common = shorter.size();
+    std::swap_ranges(shorter.begin(), shorter.end(), longer.begin());
+    std::uninitialized_move(longer.begin() + common, longer.end(),
+                            shorter.end());
+    std::destroy(longer.begin() + common, longer.end());
+    auto longer_size = longer.size();
+    longer.set_size(common);
+    shorter.set_size(longer_size);
+  }
+};
+
+// Non-member functions
+template <class T, std::size_t N>
+auto operator<=>(const inplace_vector<T, N> &lhs,
+                 const inplace_vector<T, N> &rhs) {
+  return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(),
+                                                rhs.begin(), rhs.end());
+}
+
+template <class T, std::size_t N>
+bool operator==(const inplace_vector<T, N> &lhs,
+                const inplace_vector<T, N> &rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <class T, std::size_t N>
+void swap(inplace_vector<T, N> &lhs,
+          inplace_vector<T, N> &rhs) noexcept(noexcept(lhs.swap(rhs))) {
+  lhs.swap(rhs);
+}
+} // namespace my
@@ -1,5 +1,7 @@
 #pragma once
 
+#include "allocator.h"
+#include "trace.h"
 #include <cstddef>
 #include <iterator>
 #include <limits>
@@ -32,12 +34,13 @@ template <class T> struct list_node : public base_node<T> {
   using base_pointer = base_node<T> *;
   using node_pointer = list_node<T> *;
 
-  T data;
+  // the list constructs and destroys data itself, the node only holds it
+  union {
+    T data;
+  };
 
-  constexpr list_node() noexcept = default;
-  constexpr list_node(const T &v) : data{v} {}
-  constexpr list_node(T &&v) : data{std::move(v)} {}
-  ~list_node() { data.~T(); }
+  constexpr list_node() noexcept {}
+  constexpr ~list_node() {}
 
   node_pointer self() { return static_cast<node_pointer>(&*this); }
   base_pointer as_base() { return static_cast<base_pointer>(&*this); }
@@ -48,7 +51,9 @@ public:
   using value_type = T;
   using pointer = T *;
   using reference = T &;
+  using difference_type = std::ptrdiff_t;
   using iterator = list_iterator<T>;
+  using iterator_category = std::bidirectional_iterator_tag;
   using iterator_concept = std::bidirectional_iterator_tag;
   using base_pointer = base_node<T> *;
   using node_pointer = list_node<T> *;
@@ -67,6 +72,8 @@ public:
   reference operator*() const { return m_node->as_node()->data; }
   pointer operator->() const { return &(operator*()); }
 
+  base_pointer base() const { return m_node; }
+
   iterator &operator++() {
     m_node = m_node->next;
     return *this;
@@ -104,7 +111,9 @@ public:
   using const_pointer = const T *;
   using const_reference = const T &;
   using iterator = list_iterator<T>;
+  using difference_type = std::ptrdiff_t;
   using const_iterator = list_const_iterator<T>;
+  using iterator_category = std::bidirectional_iterator_tag;
   using iterator_concept = std::bidirectional_iterator_tag;
   using base_pointer = base_node<T> *;
   using node_pointer = list_node<T> *;
@@ -116,7 +125,7 @@ public:
   constexpr list_const_iterator() noexcept = default;
   constexpr list_const_iterator(base_pointer p) : m_node{p} {}
   constexpr list_const_iterator(node_pointer p) : m_node{p->as_base()} {}
-  constexpr list_const_iterator(const iterator &other) : m_node{other.m_node} {}
+  constexpr list_const_iterator(const iterator &other) : m_node{other.base()} {}
   constexpr list_const_iterator(const const_iterator &other) = default;
 
   ~list_const_iterator() = default;
@@ -124,6 +133,8 @@ public:
   const_reference operator*() const { return m_node->as_node()->data; }
   const_pointer operator->() const { return &(operator*()); }
 
+  base_pointer base() const { return m_node; }
+
   const_iterator &operator++() {
     m_node = m_node->next;
     return *this;
@@ -156,9 +167,13 @@ public:
 };
 } // namespace detail
 
-template <class T> class list {
+// Nodes and the sentinel come from Allocator rebound to the node types, so
+// e.g. my::pool_allocator<T> puts them in shared slabs instead of separate
+// heap blocks.
+template <class T, class Allocator = allocator<T>> class list {
 public:
   using value_type = T;
+  using allocator_type = Allocator;
   using size_type = std::size_t;
   using difference_type = std::ptrdiff_t;
   using reference = T &;
@@ -177,6 +192,15 @@ public:
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 private:
+  using alloc_traits = std::allocator_traits<Allocator>;
+  using node_allocator =
+      typename alloc_traits::template rebind_alloc<detail::list_node<T>>;
+  using node_traits = std::allocator_traits<node_allocator>;
+  using sentinel_allocator =
+      typename alloc_traits::template rebind_alloc<detail::base_node<T>>;
+  using sentinel_traits = std::allocator_traits<sentinel_allocator>;
+
+  [[no_unique_address]] node_allocator m_alloc;
   base_pointer m_sentinel;
   size_type m_size;
 
@@ -184,23 +208,43 @@ private:
 
     /* create a list_node of type T with provided args */
 
-    auto *raw = new detail::list_node<value_type>;
+    node_pointer raw = std::construct_at(node_traits::allocate(m_alloc, 1));
 
     try {
       new (std::addressof(raw->data)) T(std::forward<Args>(args)...);
       raw->prev = nullptr;
       raw->next = nullptr;
+      MY_STL_TRACE(node_alloc, this, sizeof(detail::list_node<T>));
       return raw;
     } catch (...) {
-      delete raw;
+      std::destroy_at(raw);
+      node_traits::deallocate(m_alloc, raw, 1);
       throw;
     }
   }
 
-  void destroy_node(node_pointer p) { delete p; }
+  void destroy_node(node_pointer p) {
+    MY_STL_TRACE(node_free, this, sizeof(detail::list_node<T>));
+    std::destroy_at(std::addressof(p->data));
+    std::destroy_at(p);
+    node_traits::deallocate(m_alloc, p, 1);
+  }
+
+  // links a new node holding T(args...) in front of pos
+  template <class... Args>
+  iterator link_before(base_pointer pos, Args &&...args) {
+    auto node = create_node(std::forward<Args>(args)...);
+    node->prev = pos->prev;
+    node->next = pos;
+    pos->prev->next = node;
+    pos->prev = node;
+    ++m_size;
+    return node->as_base();
+  }
 
   base_pointer create_sentinel() {
-    auto *raw = new detail::base_node<value_type>;
+    sentinel_allocator alloc(m_alloc);
+    base_pointer raw = std::construct_at(sentinel_traits::allocate(alloc, 1));
 
     raw->unlink(); // point to itself
 
@@ -209,18 +253,25 @@ private:
 
   void destroy_sentinel() {
     if (m_sentinel) {
-      delete m_sentinel;
+      sentinel_allocator alloc(m_alloc);
+      std::destroy_at(m_sentinel);
+      sentinel_traits::deallocate(alloc, m_sentinel, 1);
     }
   }
 
 public:
   // ctor
-  list() : m_sentinel{create_sentinel()}, m_size{0} {}
+  list() : list(Allocator()) {}
+
+  explicit list(const Allocator &alloc)
+      : m_alloc{alloc}, m_sentinel{create_sentinel()}, m_size{0} {}
 
-  explicit list(size_type count) : list(count, T()) {}
+  explicit list(size_type count, const Allocator &alloc = Allocator())
+      : list(count, T(), alloc) {}
 
-  explicit list(size_type count, const_reference value)
-      : m_sentinel{create_sentinel()}, m_size{0} {
+  explicit list(size_type count, const_reference value,
+                const Allocator &alloc = Allocator())
+      : m_alloc{alloc}, m_sentinel{create_sentinel()}, m_size{0} {
     try {
       auto curr = m_sentinel;
       for (size_type i = 0; i < count; ++i) {
@@ -239,8 +290,9 @@ public:
     }
   }
 
-  template <class InputIt>
-  list(InputIt first, InputIt last) : m_sentinel{create_sentinel()}, m_size{0} {
+  template <std::input_iterator InputIt>
+  list(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+      : m_alloc{alloc}, m_sentinel{create_sentinel()}, m_size{0} {
     try {
       auto curr = m_sentinel;
       for (auto it = first; it != last; ++it) {
@@ -260,12 +312,75 @@ public:
   }
 
   // copy ctor
-  list(const list &other) : list(other.cbegin(), other.cend()) {}
+  list(const list &other)
+      : list(other.cbegin(), other.cend(),
+             alloc_traits::select_on_container_copy_construction(
+                 other.get_allocator())) {}
+
+  list(const list &other, const Allocator &alloc)
+      : list(other.cbegin(), other.cend(), alloc) {}
+
+  // move ctor; other gets a fresh sentinel so it stays a usable empty list
+  list(list &&other)
+      : m_alloc{other.m_alloc},
+        m_sentinel(std::exchange(other.m_sentinel, other.create_sentinel())),
+        m_size{std::exchange(other.m_size, 0)} {}
+
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(m_alloc);
+  }
+
+  // element access
+  reference front() { return *begin(); }
+
+  const_reference front() const { return *begin(); }
+
+  reference back() { return m_sentinel->prev->as_node()->data; }
 
-  // move ctor
-  list(list &&other) : m_sentinel(other.m_sentinel), m_size{other.m_size} {
-    other.m_sentinel = nullptr;
-    other.m_size = 0;
+  const_reference back() const { return m_sentinel->prev->as_node()->data; }
+
+  // copy assignment
+  list &operator=(const list &other) {
+    if (this != &other) {
+      constexpr bool propagate =
+          alloc_traits::propagate_on_container_copy_assignment::value;
+      list temp(other, propagate ? other.get_allocator() : get_allocator());
+      swap(temp);
+      if constexpr (propagate &&
+                    !node_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, temp.m_alloc);
+      }
+    }
+    return *this;
+  }
+
+  // move assignment
+  list &operator=(list &&other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
+    if (this != &other) {
+      constexpr bool propagate =
+          alloc_traits::propagate_on_container_move_assignment::value;
+      if constexpr (!propagate && !alloc_traits::is_always_equal::value) {
+        // nodes of an unequal allocator can't be adopted, move elementwise
+        if (get_allocator() != other.get_allocator()) {
+          list temp(std::make_move_iterator(other.begin()),
+                    std::make_move_iterator(other.end()), get_allocator());
+          swap(temp);
+          other.clear();
+          return *this;
+        }
+      }
+      // adopt other's nodes; other keeps this list's sentinel, emptied, and
+      // the allocator that made it
+      clear();
+      std::swap(m_sentinel, other.m_sentinel);
+      std::swap(m_size, other.m_size);
+      if constexpr (propagate) {
+        std::swap(m_alloc, other.m_alloc);
+      }
+    }
+    return *this;
   }
 
   // iterators
@@ -311,7 +426,61 @@ public:
   }
 
   iterator insert(const_iterator pos, const_reference value) {
-    auto curr = m_sentinel;
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T &&value) {
+    return emplace(pos, std::move(value));
+  }
+
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args &&...args) {
+    return link_before(pos.base(), std::forward<Args>(args)...);
+  }
+
+  void push_back(const_reference value) { emplace_back(value); }
+
+  void push_back(T &&value) { emplace_back(std::move(value)); }
+
+  template <class... Args> reference emplace_back(Args &&...args) {
+    return *link_before(m_sentinel, std::forward<Args>(args)...);
+  }
+
+  void push_front(const_reference value) { emplace_front(value); }
+
+  void push_front(T &&value) { emplace_front(std::move(value)); }
+
+  template <class... Args> reference emplace_front(Args &&...args) {
+    return *link_before(m_sentinel->next, std::forward<Args>(args)...);
+  }
+
+  iterator erase(const_iterator pos) {
+    auto node = pos.base();
+    auto next = node->next;
+    node->prev->next = next;
+    next->prev = node->prev;
+    destroy_node(node->as_node());
+    --m_size;
+    return next;
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    while (first != last) {
+      first = erase(first);
+    }
+    return last.base();
+  }
+
+  void pop_back() { erase(m_sentinel->prev); }
+
+  void pop_front() { erase(begin()); }
+
+  void swap(list &other) noexcept {
+    if constexpr (node_traits::propagate_on_container_swap::value) {
+      std::swap(m_alloc, other.m_alloc);
+    }
+    std::swap(m_sentinel, other.m_sentinel);
+    std::swap(m_size, other.m_size);
   }
 };
 } // namespace my
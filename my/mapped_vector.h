@@ -0,0 +1,354 @@
+#pragma once
+#include "mmap_allocator.h"
+#include <algorithm>
+#include <cerrno>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace my {
+
+enum class mapped_mode {
+  read_only,  // existing file, mapped PROT_READ: no growth, no writes
+  read_write, // open the file, or create it when missing
+  create,     // create the file, or truncate it to an empty vector
+};
+
+namespace detail {
+// first 64 bytes of every mapped_vector file; elements start right after,
+// so any alignment up to 64 holds inside the page aligned mapping
+struct mapped_header {
+  static constexpr char expected_magic[8] = {'M', 'Y', 'S', 'T',
+                                             'L', 'V', 'E', 'C'};
+  static constexpr std::uint32_t current_version = 1;
+
+  char magic[8];
+  std::uint32_t version;
+  std::uint32_t element_size;
+  std::uint32_t element_align;
+  std::uint32_t reserved;
+  std::uint64_t size; // element count
+  char padding[32];
+};
+static_assert(sizeof(mapped_header) == 64);
+
+[[noreturn]] inline void throw_errno(const char *what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+} // namespace detail
+
+// Vector of trivially copyable elements stored in a file. The file is mapped
+// shared, and data(), begin() and end() point straight into the mapping, so
+// loading a table costs one mmap and the page cache is shared by every
+// process that maps it. Growth extends the file with ftruncate and the
+// mapping with mremap (munmap + mmap where there is no mremap); as with
+// my::vector it invalidates pointers. The element count lives in the file
+// header and is current at all times.
+template <class T> class mapped_vector {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "my::mapped_vector: T must be trivially copyable");
+  static_assert(alignof(T) <= sizeof(detail::mapped_header),
+                "my::mapped_vector: T is over-aligned for the file layout");
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  static constexpr size_type header_bytes = sizeof(detail::mapped_header);
+
+  detail::mapped_header *header() const noexcept {
+    return static_cast<detail::mapped_header *>(m_base);
+  }
+  pointer elements() const noexcept {
+    return reinterpret_cast<pointer>(static_cast<std::byte *>(m_base) +
+                                     header_bytes);
+  }
+
+  static size_type file_bytes_for(size_type count) noexcept {
+    return detail::round_to_pages(header_bytes + count * sizeof(T));
+  }
+
+  void require_writable(const char *what) const {
+    if (m_mode == mapped_mode::read_only)
+      throw std::logic_error(what);
+  }
+
+  void map(size_type bytes) {
+    auto prot = m_mode == mapped_mode::read_only ? PROT_READ
+                                                 : PROT_READ | PROT_WRITE;
+    void *p = ::mmap(nullptr, bytes, prot, MAP_SHARED, m_fd, 0);
+    if (p == MAP_FAILED)
+      detail::throw_errno("my::mapped_vector: mmap");
+    m_base = p;
+    m_mapped = bytes;
+  }
+
+  // resizes the file and the mapping to bytes, a multiple of the page size
+  void remap(size_type bytes) {
+    if (::ftruncate(m_fd, static_cast<off_t>(bytes)) != 0)
+      detail::throw_errno("my::mapped_vector: ftruncate");
+#if defined(__linux__)
+    void *p = ::mremap(m_base, m_mapped, bytes, MREMAP_MAYMOVE);
+    if (p == MAP_FAILED)
+      detail::throw_errno("my::mapped_vector: mremap");
+    m_base = p;
+    m_mapped = bytes;
+#else
+    ::munmap(m_base, m_mapped);
+    m_base = nullptr;
+    map(bytes);
+#endif
+  }
+
+  void init_header() noexcept {
+    auto *h = header();
+    std::memset(h, 0, header_bytes);
+    std::memcpy(h->magic, detail::mapped_header::expected_magic,
+                sizeof(h->magic));
+    h->version = detail::mapped_header::current_version;
+    h->element_size = sizeof(T);
+    h->element_align = alignof(T);
+    h->size = 0;
+  }
+
+  void check_header(size_type file_bytes) const {
+    const auto *h = header();
+    if (std::memcmp(h->magic, detail::mapped_header::expected_magic,
+                    sizeof(h->magic)) != 0)
+      throw std::runtime_error("my::mapped_vector: not a mapped_vector file");
+    if (h->version != detail::mapped_header::current_version)
+      throw std::runtime_error("my::mapped_vector: unsupported file version");
+    if (h->element_size != sizeof(T) || h->element_align != alignof(T))
+      throw std::runtime_error(
+          "my::mapped_vector: file was written for a different element type");
+    // compared by division: a corrupt size could wrap size * sizeof(T)
+    if (file_bytes < header_bytes ||
+        h->size > (file_bytes - header_bytes) / sizeof(T))
+      throw std::runtime_error("my::mapped_vector: file is truncated");
+  }
+
+  void close() noexcept {
+    if (m_base != nullptr)
+      ::munmap(m_base, m_mapped);
+    if (m_fd >= 0)
+      ::close(m_fd);
+    m_base = nullptr;
+    m_mapped = 0;
+    m_fd = -1;
+  }
+
+  void grow_for(size_type count) {
+    if (count > capacity())
+      reserve(std::max(count, 2 * capacity()));
+  }
+
+  int m_fd = -1;
+  void *m_base = nullptr;
+  size_type m_mapped = 0; // bytes, equal to the file size
+  mapped_mode m_mode = mapped_mode::read_only;
+
+public:
+  // ctor
+  mapped_vector() noexcept = default;
+
+  explicit mapped_vector(const std::filesystem::path &path,
+                         mapped_mode mode = mapped_mode::read_only)
+      : m_mode{mode} {
+    int flags = O_RDONLY;
+    if (mode == mapped_mode::read_write)
+      flags = O_RDWR | O_CREAT;
+    if (mode == mapped_mode::create)
+      flags = O_RDWR | O_CREAT | O_TRUNC;
+    m_fd = ::open(path.c_str(), flags | O_CLOEXEC, 0644);
+    if (m_fd < 0)
+      detail::throw_errno("my::mapped_vector: open");
+
+    try {
+      struct stat st {};
+      if (::fstat(m_fd, &st) != 0)
+        detail::throw_errno("my::mapped_vector: fstat");
+      auto file_bytes = static_cast<size_type>(st.st_size);
+
+      if (file_bytes == 0 && mode != mapped_mode::read_only) {
+        file_bytes = file_bytes_for(0);
+        if (::ftruncate(m_fd, static_cast<off_t>(file_bytes)) != 0)
+          detail::throw_errno("my::mapped_vector: ftruncate");
+        map(file_bytes);
+        init_header();
+        return;
+      }
+      if (file_bytes < header_bytes)
+        throw std::runtime_error("my::mapped_vector: file is truncated");
+      map(file_bytes);
+      check_header(file_bytes);
+    } catch (...) {
+      close();
+      throw;
+    }
+  }
+
+  mapped_vector(const mapped_vector &) = delete;
+  mapped_vector &operator=(const mapped_vector &) = delete;
+
+  // move ctor
+  mapped_vector(mapped_vector &&other) noexcept
+      : m_fd{std::exchange(other.m_fd, -1)},
+        m_base{std::exchange(other.m_base, nullptr)},
+        m_mapped{std::exchange(other.m_mapped, 0)}, m_mode{other.m_mode} {}
+
+  mapped_vector &operator=(mapped_vector &&other) noexcept {
+    if (this != &other) {
+      mapped_vector temp(std::move(other));
+      swap(temp);
+    }
+    return *this;
+  }
+
+  // dtor, unmapping does not lose anything: the mapping is shared
+  ~mapped_vector() { close(); }
+
+  [[nodiscard]] bool is_open() const noexcept { return m_base != nullptr; }
+  [[nodiscard]] mapped_mode mode() const noexcept { return m_mode; }
+
+  // writes dirty pages back to the file before returning
+  void flush() {
+    if (m_base != nullptr && ::msync(m_base, m_mapped, MS_SYNC) != 0)
+      detail::throw_errno("my::mapped_vector: msync");
+  }
+
+  // element access
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::mapped_vector::at: index out of range");
+    }
+    return elements()[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::mapped_vector::at: index out of range");
+    }
+    return elements()[pos];
+  }
+  reference operator[](size_type pos) noexcept { return elements()[pos]; }
+  const_reference operator[](size_type pos) const noexcept {
+    return elements()[pos];
+  }
+  reference front() noexcept { return elements()[0]; }
+  const_reference front() const noexcept { return elements()[0]; }
+  reference back() noexcept { return elements()[size() - 1]; }
+  const_reference back() const noexcept { return elements()[size() - 1]; }
+  pointer data() noexcept { return m_base ? elements() : nullptr; }
+  const_pointer data() const noexcept { return m_base ? elements() : nullptr; }
+
+  // iterators
+  iterator begin() noexcept { return data(); }
+  const_iterator begin() const noexcept { return data(); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept { return data() + size(); }
+  const_iterator end() const noexcept { return data() + size(); }
+  const_iterator cend() const noexcept { return end(); }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+  [[nodiscard]] size_type size() const noexcept {
+    return m_base ? static_cast<size_type>(header()->size) : 0;
+  }
+  [[nodiscard]] size_type capacity() const noexcept {
+    return m_base ? (m_mapped - header_bytes) / sizeof(T) : 0;
+  }
+  void reserve(size_type new_cap) {
+    require_writable("my::mapped_vector::reserve: vector is read-only");
+    if (new_cap > capacity())
+      remap(file_bytes_for(new_cap));
+  }
+  // shrinks the file to the pages the elements need
+  void shrink_to_fit() {
+    require_writable("my::mapped_vector::shrink_to_fit: vector is read-only");
+    auto bytes = file_bytes_for(size());
+    if (bytes < m_mapped)
+      remap(bytes);
+  }
+
+  // modifiers
+  void clear() {
+    require_writable("my::mapped_vector::clear: vector is read-only");
+    header()->size = 0;
+  }
+
+  void push_back(const T &value) { emplace_back(value); }
+
+  template <class... Args> reference emplace_back(Args &&...args) {
+    require_writable("my::mapped_vector::emplace_back: vector is read-only");
+    T tmp(std::forward<Args>(args)...); // args may point into the mapping
+    auto n = size();
+    grow_for(n + 1);
+    auto *p = ::new (static_cast<void *>(elements() + n)) T(tmp);
+    header()->size = n + 1;
+    return *p;
+  }
+
+  void pop_back() {
+    require_writable("my::mapped_vector::pop_back: vector is read-only");
+    --header()->size;
+  }
+
+  void resize(size_type count) { resize(count, T()); }
+
+  void resize(size_type count, const T &value) {
+    require_writable("my::mapped_vector::resize: vector is read-only");
+    auto n = size();
+    if (count > n) {
+      T tmp = value;
+      grow_for(count);
+      std::uninitialized_fill(elements() + n, elements() + count, tmp);
+    }
+    header()->size = count;
+  }
+
+  template <std::input_iterator InputIt>
+  void append(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      emplace_back(*first);
+    }
+  }
+
+  void swap(mapped_vector &other) noexcept {
+    std::swap(m_fd, other.m_fd);
+    std::swap(m_base, other.m_base);
+    std::swap(m_mapped, other.m_mapped);
+    std::swap(m_mode, other.m_mode);
+  }
+};
+} // namespace my
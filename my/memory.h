@@ -1,5 +1,7 @@
 #pragma once
+#include "type_traits.h"
 #include <concepts>
+#include <memory>
 #include <type_traits>
 #include <print>
 #include <utility>
@@ -92,6 +94,15 @@ public:
 template <typename D>
 concept has_pointer_type = requires { typename D::pointer; };
 
+template <class T, class D> struct unique_ptr_pointer {
+  using type = T *;
+};
+template <class T, class D>
+  requires has_pointer_type<D>
+struct unique_ptr_pointer<T, D> {
+  using type = typename D::pointer;
+};
+
 template <typename D>
 concept unique_ptr_enable_default_t =
     !std::is_pointer_v<D> && std::default_initializable<D>;
@@ -100,9 +111,7 @@ concept unique_ptr_enable_default_t =
 template <class T, class Deleter = default_delete<T>> class unique_ptr {
 public:
   using pointer =
-      std::conditional_t<has_pointer_type<std::remove_reference_t<Deleter>>,
-                         typename std::remove_reference_t<Deleter>::pointer,
-                         T *>;
+      typename unique_ptr_pointer<T, std::remove_reference_t<Deleter>>::type;
   using element_type = T;
   using deleter_type = Deleter;
 
@@ -122,12 +131,32 @@ public:
     requires unique_ptr_enable_default_t<deleter_type>
       : unique_ptr() {}
 
+  constexpr explicit unique_ptr(pointer ptr) noexcept
+    requires unique_ptr_enable_default_t<deleter_type>
+      : m_pair(m_zero_then_variadic_args_t{}, ptr) {}
+
+  constexpr unique_ptr(pointer ptr, const deleter_type &d) noexcept
+      : m_pair(m_one_then_variadic_args_t{}, d, ptr) {}
+
   unique_ptr(const unique_ptr &) = delete;
 
+  constexpr unique_ptr(unique_ptr &&other) noexcept
+      : m_pair(m_one_then_variadic_args_t{},
+               std::forward<deleter_type>(other.get_deleter()),
+               other.release()) {}
+
   // member functions
 
   unique_ptr &operator=(const unique_ptr &) = delete;
 
+  constexpr unique_ptr &operator=(unique_ptr &&other) noexcept {
+    if (this != &other) {
+      reset(other.release());
+      get_deleter() = std::forward<deleter_type>(other.get_deleter());
+    }
+    return *this;
+  }
+
   // modifiers
   constexpr pointer release() noexcept {
     return std::exchange(m_pair.get_second(), nullptr);
@@ -138,7 +167,7 @@ public:
     }
   }
   void swap(unique_ptr &other) noexcept {
-    if (*this != other) {
+    if (this != &other) {
       std::swap(m_pair.get_first(), other.m_pair.get_first());
       std::swap(m_pair.get_second(), other.m_pair.get_second());
     }
@@ -171,4 +200,44 @@ public:
 };
 
 template <class T, class Deleter> class unique_ptr<T[], Deleter>;
+
+// deleter for objects made by allocate_unique: destroys and hands the memory
+// back to a copy of the allocator that made it
+template <class T, class Alloc> struct allocator_delete {
+  using allocator_type =
+      typename std::allocator_traits<Alloc>::template rebind_alloc<T>;
+  using traits = std::allocator_traits<allocator_type>;
+
+  allocator_type alloc;
+
+  allocator_delete() = default;
+  explicit allocator_delete(const Alloc &a) : alloc(a) {}
+
+  void operator()(T *ptr) {
+    traits::destroy(alloc, ptr);
+    traits::deallocate(alloc, ptr, 1);
+  }
+};
+
+// a T built from args in memory from alloc, e.g. a polymorphic_allocator
+// over a per-request arena
+template <class T, class Alloc, class... Args>
+unique_ptr<T, allocator_delete<T, Alloc>> allocate_unique(const Alloc &alloc,
+                                                          Args &&...args) {
+  allocator_delete<T, Alloc> d(alloc);
+  T *ptr = allocator_delete<T, Alloc>::traits::allocate(d.alloc, 1);
+  try {
+    allocator_delete<T, Alloc>::traits::construct(d.alloc, ptr,
+                                                  std::forward<Args>(args)...);
+  } catch (...) {
+    allocator_delete<T, Alloc>::traits::deallocate(d.alloc, ptr, 1);
+    throw;
+  }
+  return unique_ptr<T, allocator_delete<T, Alloc>>(ptr, d);
+}
+
+// a unique_ptr is a pointer plus an (empty) deleter, nothing refers back to it
+template <class T>
+struct is_trivially_relocatable<unique_ptr<T, default_delete<T>>>
+    : true_type {};
 } // namespace my
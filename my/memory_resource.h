@@ -0,0 +1,459 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <memory>
+#include <new>
+#include <utility>
+
+// Runtime-polymorphic memory resources and the allocator that forwards to
+// them, after std::pmr. Containers with a polymorphic_allocator share one
+// type whatever resource they draw from, so e.g. a request handler can
+// build all its scratch containers in one monotonic_buffer_resource and
+// free the lot by destroying it.
+
+namespace my {
+
+class memory_resource {
+public:
+  virtual ~memory_resource() = default;
+
+  [[nodiscard]] void *allocate(std::size_t bytes,
+                               std::size_t alignment = max_align) {
+    return do_allocate(bytes, alignment);
+  }
+
+  void deallocate(void *p, std::size_t bytes,
+                  std::size_t alignment = max_align) {
+    do_deallocate(p, bytes, alignment);
+  }
+
+  [[nodiscard]] bool is_equal(const memory_resource &other) const noexcept {
+    return do_is_equal(other);
+  }
+
+  friend bool operator==(const memory_resource &lhs,
+                         const memory_resource &rhs) noexcept {
+    return &lhs == &rhs || lhs.is_equal(rhs);
+  }
+
+protected:
+  static constexpr std::size_t max_align = alignof(std::max_align_t);
+
+private:
+  virtual void *do_allocate(std::size_t bytes, std::size_t alignment) = 0;
+  virtual void do_deallocate(void *p, std::size_t bytes,
+                             std::size_t alignment) = 0;
+  virtual bool do_is_equal(const memory_resource &other) const noexcept = 0;
+};
+
+namespace detail {
+class new_delete_resource final : public memory_resource {
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    return ::operator new(bytes, std::align_val_t{alignment});
+  }
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    ::operator delete(p, bytes, std::align_val_t{alignment});
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+class null_memory_resource final : public memory_resource {
+  void *do_allocate(std::size_t, std::size_t) override {
+    throw std::bad_alloc();
+  }
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+// the resources below are never destroyed, they may be used from static
+// destructors
+inline std::atomic<memory_resource *> &default_resource() noexcept {
+  static std::atomic<memory_resource *> resource{nullptr};
+  return resource;
+}
+} // namespace detail
+
+// ::operator new and ::operator delete
+inline memory_resource *new_delete_resource() noexcept {
+  static auto *resource = new detail::new_delete_resource;
+  return resource;
+}
+
+// throws std::bad_alloc on every allocation, as the upstream of a resource
+// that must stay within its initial buffer
+inline memory_resource *null_memory_resource() noexcept {
+  static auto *resource = new detail::null_memory_resource;
+  return resource;
+}
+
+// the resource of default-constructed polymorphic_allocators and of the
+// resources below when no upstream is given; new_delete_resource() unless set
+inline memory_resource *get_default_resource() noexcept {
+  auto *r = detail::default_resource().load(std::memory_order_acquire);
+  return r != nullptr ? r : new_delete_resource();
+}
+
+// returns the previous default; nullptr restores new_delete_resource()
+inline memory_resource *set_default_resource(memory_resource *r) noexcept {
+  auto *old = detail::default_resource().exchange(r, std::memory_order_acq_rel);
+  return old != nullptr ? old : new_delete_resource();
+}
+
+// Arena: hands out memory by bumping a pointer through a buffer, asks
+// upstream for a twice as large buffer when the current one is used up,
+// and ignores deallocate. Everything goes back to upstream at once in
+// release() or the destructor. Not thread safe.
+class monotonic_buffer_resource : public memory_resource {
+public:
+  monotonic_buffer_resource() noexcept
+      : monotonic_buffer_resource(get_default_resource()) {}
+
+  explicit monotonic_buffer_resource(memory_resource *upstream) noexcept
+      : m_upstream{upstream} {}
+
+  explicit monotonic_buffer_resource(
+      std::size_t initial_size,
+      memory_resource *upstream = get_default_resource()) noexcept
+      : m_upstream{upstream}, m_first_size{std::max<std::size_t>(
+                                  initial_size, sizeof(chunk) + 1)},
+        m_next_size{m_first_size} {}
+
+  // starts in buffer, which the resource never frees
+  monotonic_buffer_resource(
+      void *buffer, std::size_t size,
+      memory_resource *upstream = get_default_resource()) noexcept
+      : m_upstream{upstream}, m_buffer{buffer}, m_buffer_size{size},
+        m_first_size{std::max(2 * size, default_size)},
+        m_current{buffer}, m_space{size}, m_next_size{m_first_size} {}
+
+  monotonic_buffer_resource(const monotonic_buffer_resource &) = delete;
+  monotonic_buffer_resource &
+  operator=(const monotonic_buffer_resource &) = delete;
+
+  ~monotonic_buffer_resource() override { release(); }
+
+  // frees every buffer taken from upstream and starts over
+  void release() noexcept {
+    while (m_chunks != nullptr) {
+      auto *c = std::exchange(m_chunks, m_chunks->prev);
+      m_upstream->deallocate(c, c->bytes, alignof(chunk));
+    }
+    m_current = m_buffer;
+    m_space = m_buffer_size;
+    m_next_size = m_first_size;
+  }
+
+  [[nodiscard]] memory_resource *upstream_resource() const noexcept {
+    return m_upstream;
+  }
+
+private:
+  static constexpr std::size_t default_size = 1024;
+
+  // header at the front of every buffer from upstream
+  struct alignas(std::max_align_t) chunk {
+    chunk *prev;
+    std::size_t bytes;
+  };
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    void *p = m_current;
+    if (std::align(alignment, bytes, p, m_space) == nullptr) {
+      grow(bytes, alignment);
+      p = m_current;
+      std::align(alignment, bytes, p, m_space);
+    }
+    m_current = static_cast<std::byte *>(p) + bytes;
+    m_space -= bytes;
+    return p;
+  }
+
+  void do_deallocate(void *, std::size_t, std::size_t) override {}
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  void grow(std::size_t bytes, std::size_t alignment) {
+    if (bytes > std::numeric_limits<std::size_t>::max() / 2 - alignment)
+      throw std::bad_alloc();
+    auto size = std::max(m_next_size, sizeof(chunk) + bytes + alignment);
+    auto *c = ::new (m_upstream->allocate(size, alignof(chunk)))
+        chunk{m_chunks, size};
+    m_chunks = c;
+    m_current = c + 1;
+    m_space = size - sizeof(chunk);
+    if (m_next_size <= std::numeric_limits<std::size_t>::max() / 2)
+      m_next_size = 2 * size;
+  }
+
+  memory_resource *m_upstream;
+  void *m_buffer = nullptr;
+  std::size_t m_buffer_size = 0;
+  std::size_t m_first_size = default_size;
+  chunk *m_chunks = nullptr;
+  void *m_current = nullptr;
+  std::size_t m_space = 0;
+  std::size_t m_next_size = default_size;
+};
+
+struct pool_options {
+  // blocks per chunk a pool may grow to; 0 picks the default
+  std::size_t max_blocks_per_chunk = 0;
+  // largest allocation served from a pool, bigger ones go straight to
+  // upstream; 0 picks the default
+  std::size_t largest_required_pool_block = 0;
+};
+
+// Pools of power-of-two sized blocks from 8 bytes up to
+// largest_required_pool_block, each a free list over chunks that double in
+// size up to max_blocks_per_chunk blocks. Freed blocks return to their pool
+// and are reused; chunks and the blocks too large for any pool go back to
+// upstream in release() or the destructor. Not thread safe.
+class unsynchronized_pool_resource : public memory_resource {
+public:
+  unsynchronized_pool_resource()
+      : unsynchronized_pool_resource(pool_options{}, get_default_resource()) {
+  }
+
+  explicit unsynchronized_pool_resource(memory_resource *upstream)
+      : unsynchronized_pool_resource(pool_options{}, upstream) {}
+
+  explicit unsynchronized_pool_resource(const pool_options &opts)
+      : unsynchronized_pool_resource(opts, get_default_resource()) {}
+
+  unsynchronized_pool_resource(const pool_options &opts,
+                               memory_resource *upstream)
+      : m_upstream{upstream}, m_options{normalize(opts)},
+        m_pool_count{static_cast<unsigned>(
+            pool_index(m_options.largest_required_pool_block) + 1)} {}
+
+  unsynchronized_pool_resource(const unsynchronized_pool_resource &) = delete;
+  unsynchronized_pool_resource &
+  operator=(const unsynchronized_pool_resource &) = delete;
+
+  ~unsynchronized_pool_resource() override { release(); }
+
+  void release() noexcept {
+    for (unsigned i = 0; i < m_pool_count; ++i) {
+      auto &p = m_pools[i];
+      auto block_size = min_block << i;
+      while (p.chunks != nullptr) {
+        auto *c = std::exchange(p.chunks, p.chunks->next);
+        auto *start = reinterpret_cast<std::byte *>(c) - c->blocks * block_size;
+        m_upstream->deallocate(start, c->blocks * block_size + sizeof(chunk),
+                               block_size);
+      }
+      p = pool{};
+    }
+    while (m_large != nullptr) {
+      auto *h = std::exchange(m_large, m_large->next);
+      m_upstream->deallocate(h->raw, h->bytes, h->alignment);
+    }
+  }
+
+  [[nodiscard]] memory_resource *upstream_resource() const noexcept {
+    return m_upstream;
+  }
+
+  [[nodiscard]] pool_options options() const noexcept { return m_options; }
+
+private:
+  static constexpr std::size_t min_block = 8;
+  static constexpr unsigned max_pools = 18; // 8 bytes to 1 MiB
+
+  struct block {
+    block *next;
+  };
+
+  // trailer behind the blocks of every chunk
+  struct chunk {
+    chunk *next;
+    std::size_t blocks;
+  };
+
+  struct pool {
+    block *free = nullptr;
+    chunk *chunks = nullptr;
+    std::size_t next_blocks = 0;
+  };
+
+  // header right in front of every block too large for the pools
+  struct large_header {
+    large_header *prev;
+    large_header *next;
+    void *raw;
+    std::size_t bytes;
+    std::size_t alignment;
+  };
+
+  static pool_options normalize(pool_options opts) noexcept {
+    if (opts.max_blocks_per_chunk == 0)
+      opts.max_blocks_per_chunk = 1024;
+    opts.max_blocks_per_chunk =
+        std::min<std::size_t>(opts.max_blocks_per_chunk, 1u << 20);
+    if (opts.largest_required_pool_block == 0)
+      opts.largest_required_pool_block = 4096;
+    opts.largest_required_pool_block =
+        std::bit_ceil(std::clamp(opts.largest_required_pool_block, min_block,
+                                 min_block << (max_pools - 1)));
+    return opts;
+  }
+
+  static std::size_t pool_index(std::size_t size) noexcept {
+    return std::bit_width(std::max(size, min_block) - 1) -
+           std::bit_width(min_block - 1);
+  }
+
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    auto size = std::max(bytes, alignment);
+    if (size > m_options.largest_required_pool_block)
+      return allocate_large(bytes, alignment);
+    auto i = pool_index(size);
+    auto &p = m_pools[i];
+    if (p.free == nullptr)
+      grow(p, min_block << i);
+    return std::exchange(p.free, p.free->next);
+  }
+
+  void do_deallocate(void *ptr, std::size_t bytes,
+                     std::size_t alignment) override {
+    auto size = std::max(bytes, alignment);
+    if (size > m_options.largest_required_pool_block) {
+      deallocate_large(ptr);
+      return;
+    }
+    auto &p = m_pools[pool_index(size)];
+    auto *b = static_cast<block *>(ptr);
+    b->next = p.free;
+    p.free = b;
+  }
+
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+
+  // a chunk aligned to the block size holds blocks aligned to it as well,
+  // which covers every alignment that maps to this pool
+  void grow(pool &p, std::size_t block_size) {
+    if (p.next_blocks == 0) {
+      p.next_blocks = std::clamp<std::size_t>(
+          4096 / block_size, 1, m_options.max_blocks_per_chunk);
+    }
+    auto blocks = p.next_blocks;
+    auto *start = static_cast<std::byte *>(m_upstream->allocate(
+        blocks * block_size + sizeof(chunk), block_size));
+    auto *c = ::new (start + blocks * block_size) chunk{p.chunks, blocks};
+    p.chunks = c;
+    for (auto i = blocks; i != 0; --i) {
+      auto *b = reinterpret_cast<block *>(start + (i - 1) * block_size);
+      b->next = p.free;
+      p.free = b;
+    }
+    p.next_blocks = std::min(2 * blocks, m_options.max_blocks_per_chunk);
+  }
+
+  void *allocate_large(std::size_t bytes, std::size_t alignment) {
+    alignment = std::max(alignment, alignof(large_header));
+    auto offset =
+        (sizeof(large_header) + alignment - 1) / alignment * alignment;
+    if (bytes > std::numeric_limits<std::size_t>::max() - offset)
+      throw std::bad_alloc();
+    auto total = offset + bytes;
+    auto *raw =
+        static_cast<std::byte *>(m_upstream->allocate(total, alignment));
+    auto *h = ::new (raw + offset - sizeof(large_header))
+        large_header{nullptr, m_large, raw, total, alignment};
+    if (m_large != nullptr)
+      m_large->prev = h;
+    m_large = h;
+    return raw + offset;
+  }
+
+  void deallocate_large(void *ptr) noexcept {
+    auto *h = reinterpret_cast<large_header *>(static_cast<std::byte *>(ptr) -
+                                               sizeof(large_header));
+    (h->prev != nullptr ? h->prev->next : m_large) = h->next;
+    if (h->next != nullptr)
+      h->next->prev = h->prev;
+    m_upstream->deallocate(h->raw, h->bytes, h->alignment);
+  }
+
+  memory_resource *m_upstream;
+  pool_options m_options;
+  unsigned m_pool_count;
+  pool m_pools[max_pools];
+  large_header *m_large = nullptr;
+};
+
+// Allocator over a memory_resource, the default resource unless one is
+// given. Copies of a container keep the default resource rather than the
+// source's (select_on_container_copy_construction), and the resource never
+// moves between containers on assignment or swap.
+template <class T = std::byte> class polymorphic_allocator {
+public:
+  using value_type = T;
+
+  polymorphic_allocator() noexcept : m_resource{get_default_resource()} {}
+  polymorphic_allocator(memory_resource *r) noexcept : m_resource{r} {}
+  polymorphic_allocator(const polymorphic_allocator &) = default;
+  template <class U>
+  polymorphic_allocator(const polymorphic_allocator<U> &other) noexcept
+      : m_resource{other.resource()} {}
+
+  [[nodiscard]] T *allocate(std::size_t n) {
+    if (n > std::numeric_limits<std::size_t>::max() / sizeof(T))
+      throw std::bad_array_new_length();
+    return static_cast<T *>(m_resource->allocate(n * sizeof(T), alignof(T)));
+  }
+
+  void deallocate(T *p, std::size_t n) noexcept {
+    m_resource->deallocate(p, n * sizeof(T), alignof(T));
+  }
+
+  // one U built from args in memory from the resource
+  template <class U, class... Args>
+  [[nodiscard]] U *new_object(Args &&...args) {
+    polymorphic_allocator<U> alloc(*this);
+    U *p = alloc.allocate(1);
+    try {
+      return std::construct_at(p, std::forward<Args>(args)...);
+    } catch (...) {
+      alloc.deallocate(p, 1);
+      throw;
+    }
+  }
+
+  template <class U> void delete_object(U *p) noexcept {
+    std::destroy_at(p);
+    polymorphic_allocator<U>(*this).deallocate(p, 1);
+  }
+
+  [[nodiscard]] polymorphic_allocator
+  select_on_container_copy_construction() const noexcept {
+    return polymorphic_allocator();
+  }
+
+  [[nodiscard]] memory_resource *resource() const noexcept {
+    return m_resource;
+  }
+
+  template <class U>
+  friend bool operator==(const polymorphic_allocator &lhs,
+                         const polymorphic_allocator<U> &rhs) noexcept {
+    return *lhs.resource() == *rhs.resource();
+  }
+
+private:
+  memory_resource *m_resource;
+};
+} // namespace my
@@ -0,0 +1,165 @@
+#pragma once
+#include "allocator.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <limits>
+#include <new>
+#include <type_traits>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+namespace my {
+
+namespace detail {
+inline std::size_t page_size() noexcept {
+  static const auto size = static_cast<std::size_t>(::sysconf(_SC_PAGESIZE));
+  return size;
+}
+
+inline std::size_t round_to_pages(std::size_t bytes) noexcept {
+  auto page = page_size();
+  return (bytes + page - 1) / page * page;
+}
+} // namespace detail
+
+// Allocator for very large buffers of trivially relocatable elements.
+// Blocks below Threshold bytes come from malloc and grow with realloc; larger
+// ones are private anonymous mappings that grow with mremap, which moves page
+// table entries instead of copying bytes and never holds old and new buffer
+// at the same time. my::vector picks up reallocate() on its own.
+template <class T, std::size_t Threshold = std::size_t{1} << 20>
+struct mmap_allocator {
+  static_assert(Threshold > 0,
+                "my::mmap_allocator: threshold must be non-zero");
+  static_assert(alignof(T) <= alignof(std::max_align_t),
+                "my::mmap_allocator: malloc and realloc can't over-align");
+
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  template <class U> struct rebind {
+    using other = mmap_allocator<U, Threshold>;
+  };
+
+  constexpr mmap_allocator() noexcept = default;
+  template <class U>
+  constexpr mmap_allocator(const mmap_allocator<U, Threshold> &) noexcept {}
+
+  [[nodiscard]] pointer allocate(size_type n) {
+    return allocate_at_least(n).ptr;
+  }
+
+  [[nodiscard]] allocation_result<pointer> allocate_at_least(size_type n) {
+    if (n == 0)
+      return {nullptr, 0};
+    if (n > std::numeric_limits<size_type>::max() / sizeof(value_type))
+      throw std::bad_array_new_length();
+
+    if (!is_mapped(n)) {
+      void *raw = std::malloc(n * sizeof(value_type));
+      if (raw == nullptr)
+        throw std::bad_alloc();
+      return {static_cast<pointer>(raw), malloc_count(raw, n)};
+    }
+
+    auto bytes = mapped_bytes(n);
+    void *raw = ::mmap(nullptr, bytes, PROT_READ | PROT_WRITE,
+                       MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED)
+      throw std::bad_alloc();
+    return {static_cast<pointer>(raw), mapped_count(bytes)};
+  }
+
+  // n must be the count the block was obtained with
+  void deallocate(pointer p, size_type n) noexcept {
+    if (p == nullptr)
+      return;
+    if (is_mapped(n)) {
+      ::munmap(p, mapped_bytes(n));
+    } else {
+      std::free(p);
+    }
+  }
+
+  // resizes the block holding old_n elements to fit at least new_n of them,
+  // moving the contents bytewise; p is invalid afterwards
+  [[nodiscard]] allocation_result<pointer>
+  reallocate(pointer p, size_type old_n, size_type new_n) {
+    if (p == nullptr)
+      return allocate_at_least(new_n);
+    if (new_n == 0) {
+      deallocate(p, old_n);
+      return {nullptr, 0};
+    }
+    if (new_n > std::numeric_limits<size_type>::max() / sizeof(value_type))
+      throw std::bad_array_new_length();
+
+    if (!is_mapped(old_n) && !is_mapped(new_n)) {
+      void *raw = std::realloc(p, new_n * sizeof(value_type));
+      if (raw == nullptr)
+        throw std::bad_alloc();
+      return {static_cast<pointer>(raw), malloc_count(raw, new_n)};
+    }
+
+#if defined(__linux__)
+    if (is_mapped(old_n) && is_mapped(new_n)) {
+      auto new_bytes = mapped_bytes(new_n);
+      void *raw =
+          ::mremap(p, mapped_bytes(old_n), new_bytes, MREMAP_MAYMOVE);
+      if (raw == MAP_FAILED)
+        throw std::bad_alloc();
+      return {static_cast<pointer>(raw), mapped_count(new_bytes)};
+    }
+#endif
+
+    // crossing the threshold (or no mremap): copy once
+    auto result = allocate_at_least(new_n);
+    std::memcpy(static_cast<void *>(result.ptr), static_cast<const void *>(p),
+                std::min(old_n, new_n) * sizeof(value_type));
+    deallocate(p, old_n);
+    return result;
+  }
+
+  template <class U>
+  friend constexpr bool operator==(const mmap_allocator &,
+                                   const mmap_allocator<U, Threshold> &) {
+    return true;
+  }
+
+private:
+  static constexpr bool is_mapped(size_type n) noexcept {
+    return n * sizeof(value_type) >= Threshold;
+  }
+
+  // length of the mapping behind a block of n elements
+  static size_type mapped_bytes(size_type n) noexcept {
+    return detail::round_to_pages(n * sizeof(value_type));
+  }
+
+  // the count reported for a mapping of bytes; deallocate() and
+  // reallocate() get it back and must arrive at the same length, also
+  // when an element is larger than a page
+  static size_type mapped_count(size_type bytes) noexcept {
+    auto count = bytes / sizeof(value_type);
+    assert(mapped_bytes(count) == bytes);
+    return count;
+  }
+
+  // usable slots of a malloc block, kept below the threshold so that
+  // deallocate() still recognises the block as malloc'ed
+  static size_type malloc_count(void *raw, size_type n) noexcept {
+    auto count = detail::usable_size(raw, n * sizeof(value_type)) /
+                 sizeof(value_type);
+    return std::min(count, (Threshold - 1) / sizeof(value_type));
+  }
+};
+} // namespace my
@@ -0,0 +1,809 @@
+#pragma once
+#include <algorithm>
+#include <atomic>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+
+namespace my {
+
+namespace detail {
+
+inline constexpr unsigned rrb_bits = 5;
+inline constexpr std::uint32_t rrb_branches = 1u << rrb_bits;
+
+// Nodes are shared between versions and freed by whichever version drops the
+// last reference, on whatever thread that happens. A node with a single
+// reference belongs to the one tree that holds it, which may change it in
+// place: nobody else can reach it to take a new reference meanwhile.
+struct rrb_node {
+  std::atomic<std::uint32_t> refs{1};
+  std::uint32_t count = 0;
+};
+
+template <class T> struct rrb_leaf : rrb_node {
+  rrb_leaf() noexcept {}
+  ~rrb_leaf() { std::destroy_n(elems, count); }
+
+  union {
+    T elems[rrb_branches];
+  };
+};
+
+// sizes[i] counts the elements in children 0..i. Every inner node keeps the
+// table, so relaxed nodes (after a concatenation or a slice) and regular
+// ones (dense on the left) are searched the same way; for regular ones the
+// radix guess in find_child is simply right the first time.
+struct rrb_inner : rrb_node {
+  rrb_node *children[rrb_branches];
+  std::size_t sizes[rrb_branches];
+};
+
+// Relaxed radix balanced tree: 32-way nodes, elements in the leaves, height
+// given by shift (0 for a lone leaf, 5 more per inner level). Copies share
+// the whole tree; the mutating members only copy the nodes on the paths they
+// touch that are still shared, so the caller decides between a new version
+// (copy first) and an in-place batch (keep the tree to itself).
+template <class T> class rrb_tree {
+public:
+  using size_type = std::size_t;
+
+  struct leaf_span {
+    const T *elems;
+    size_type first;
+    size_type count;
+  };
+
+  rrb_tree() = default;
+  rrb_tree(const rrb_tree &other) noexcept
+      : m_root{other.m_root}, m_shift{other.m_shift}, m_size{other.m_size} {
+    if (m_root != nullptr)
+      retain(m_root);
+  }
+  rrb_tree(rrb_tree &&other) noexcept
+      : m_root{std::exchange(other.m_root, nullptr)},
+        m_shift{std::exchange(other.m_shift, 0)},
+        m_size{std::exchange(other.m_size, 0)} {}
+  rrb_tree &operator=(rrb_tree other) noexcept {
+    swap(other);
+    return *this;
+  }
+  ~rrb_tree() {
+    if (m_root != nullptr)
+      release(m_root, m_shift);
+  }
+
+  void swap(rrb_tree &other) noexcept {
+    std::swap(m_root, other.m_root);
+    std::swap(m_shift, other.m_shift);
+    std::swap(m_size, other.m_size);
+  }
+
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+
+  // the leaf holding element i, and the index of its first element
+  leaf_span find_leaf(size_type i) const noexcept {
+    const rrb_node *n = m_root;
+    size_type first = 0;
+    for (auto shift = m_shift; shift != 0; shift -= rrb_bits) {
+      auto *in = static_cast<const rrb_inner *>(n);
+      auto idx = find_child(in, shift, i);
+      if (idx != 0) {
+        first += in->sizes[idx - 1];
+        i -= in->sizes[idx - 1];
+      }
+      n = in->children[idx];
+    }
+    auto *lf = static_cast<const leaf *>(n);
+    return {lf->elems, first, lf->count};
+  }
+
+  const T &operator[](size_type i) const noexcept {
+    auto span = find_leaf(i);
+    return span.elems[i - span.first];
+  }
+
+  template <class... Args> void emplace_back(Args &&...args) {
+    if (m_root == nullptr) {
+      m_root = new_path(0, std::forward<Args>(args)...);
+      m_shift = 0;
+      m_size = 1;
+      return;
+    }
+    if (!has_room(m_root, m_shift)) {
+      // the tree is full along its right edge: grow a level on top
+      auto *top = new rrb_inner;
+      top->count = 1;
+      top->children[0] = m_root;
+      top->sizes[0] = m_size;
+      m_root = top;
+      m_shift += rrb_bits;
+    }
+    push(m_root, m_shift, std::forward<Args>(args)...);
+    ++m_size;
+  }
+
+  template <class U> void assign(size_type i, U &&value) {
+    rrb_node **slot = &m_root;
+    for (auto shift = m_shift; shift != 0; shift -= rrb_bits) {
+      auto *in = unique_inner(*slot, shift);
+      auto idx = find_child(in, shift, i);
+      if (idx != 0)
+        i -= in->sizes[idx - 1];
+      slot = &in->children[idx];
+    }
+    unique_leaf(*slot)->elems[i] = std::forward<U>(value);
+  }
+
+  // keeps the first n elements
+  void truncate(size_type n) {
+    if (n >= m_size)
+      return;
+    if (n == 0) {
+      *this = rrb_tree();
+      return;
+    }
+    truncate(m_root, m_shift, n);
+    m_size = n;
+    squeeze();
+  }
+
+  // removes the first n elements
+  void drop_front(size_type n) {
+    if (n == 0)
+      return;
+    if (n >= m_size) {
+      *this = rrb_tree();
+      return;
+    }
+    drop(m_root, m_shift, n);
+    m_size -= n;
+    squeeze();
+  }
+
+  // Appends the elements of right. Only the nodes along the seam between
+  // the two trees are rebuilt, and those are repacked just enough to keep
+  // at most two more nodes per level than a dense tree would need, which
+  // bounds the height by O(log n).
+  void append(const rrb_tree &right) {
+    if (right.m_size == 0)
+      return;
+    if (m_size == 0) {
+      *this = right;
+      return;
+    }
+    auto merged = merge(m_root, m_shift, right.m_root, right.m_shift);
+    auto shift = merged.shift;
+    rrb_node *root;
+    if (merged.count == 1) {
+      root = std::exchange(merged.items[0], nullptr);
+      merged.count = 0;
+    } else {
+      root = make_inner(merged, 0, merged.count, shift + rrb_bits);
+      shift += rrb_bits;
+    }
+    release(m_root, m_shift);
+    m_root = root;
+    m_shift = shift;
+    m_size += right.m_size;
+    squeeze();
+  }
+
+private:
+  using leaf = rrb_leaf<T>;
+
+  // up to two nodes' worth of children of one level, each reference owned
+  struct node_list {
+    explicit node_list(unsigned s) noexcept : shift{s} {}
+    node_list(node_list &&other) noexcept
+        : shift{other.shift}, count{std::exchange(other.count, 0)} {
+      std::copy_n(other.items, count, items);
+    }
+    node_list &operator=(node_list &&) = delete;
+    ~node_list() {
+      for (std::uint32_t i = 0; i < count; ++i) {
+        if (items[i] != nullptr)
+          release(items[i], shift);
+      }
+    }
+
+    void push_shared(rrb_node *const *nodes, std::uint32_t n) noexcept {
+      for (std::uint32_t i = 0; i < n; ++i) {
+        retain(nodes[i]);
+        items[count++] = nodes[i];
+      }
+    }
+
+    void take_all(node_list &other) noexcept {
+      std::copy_n(other.items, other.count, items + count);
+      count += std::exchange(other.count, 0);
+    }
+
+    unsigned shift;
+    std::uint32_t count = 0;
+    rrb_node *items[2 * rrb_branches];
+  };
+
+  static void retain(rrb_node *n) noexcept {
+    n->refs.fetch_add(1, std::memory_order_relaxed);
+  }
+
+  static void release(rrb_node *n, unsigned shift) noexcept {
+    if (n->refs.fetch_sub(1, std::memory_order_acq_rel) != 1)
+      return;
+    if (shift == 0) {
+      delete static_cast<leaf *>(n);
+      return;
+    }
+    auto *in = static_cast<rrb_inner *>(n);
+    for (std::uint32_t i = 0; i < in->count; ++i) {
+      release(in->children[i], shift - rrb_bits);
+    }
+    delete in;
+  }
+
+  static size_type subtree_size(const rrb_node *n, unsigned shift) noexcept {
+    if (shift == 0)
+      return n->count;
+    auto *in = static_cast<const rrb_inner *>(n);
+    return in->sizes[in->count - 1];
+  }
+
+  // No child holds more than 1 << shift elements, so the child holding i is
+  // never left of i >> shift
+  static std::uint32_t find_child(const rrb_inner *in, unsigned shift,
+                                  size_type i) noexcept {
+    auto idx = static_cast<std::uint32_t>(i >> shift);
+    while (in->sizes[idx] <= i)
+      ++idx;
+    return idx;
+  }
+
+  static bool has_room(const rrb_node *n, unsigned shift) noexcept {
+    for (; shift != 0; shift -= rrb_bits) {
+      auto *in = static_cast<const rrb_inner *>(n);
+      if (in->count < rrb_branches)
+        return true;
+      n = in->children[in->count - 1];
+    }
+    return n->count < rrb_branches;
+  }
+
+  // the node in slot, copied first if another tree shares it
+  static leaf *unique_leaf(rrb_node *&slot) {
+    auto *lf = static_cast<leaf *>(slot);
+    if (lf->refs.load(std::memory_order_acquire) == 1)
+      return lf;
+    auto copy = std::make_unique<leaf>();
+    std::uninitialized_copy_n(lf->elems, lf->count, copy->elems);
+    copy->count = lf->count;
+    release(lf, 0);
+    slot = copy.get();
+    return copy.release();
+  }
+
+  static rrb_inner *unique_inner(rrb_node *&slot, unsigned shift) {
+    auto *in = static_cast<rrb_inner *>(slot);
+    if (in->refs.load(std::memory_order_acquire) == 1)
+      return in;
+    auto *copy = new rrb_inner;
+    copy->count = in->count;
+    std::copy_n(in->children, in->count, copy->children);
+    std::copy_n(in->sizes, in->count, copy->sizes);
+    for (std::uint32_t i = 0; i < in->count; ++i) {
+      retain(copy->children[i]);
+    }
+    // the other owners may have let go meanwhile
+    release(in, shift);
+    slot = copy;
+    return copy;
+  }
+
+  // a leaf holding one new element, under single-child inner nodes up to
+  // height shift
+  template <class... Args>
+  static rrb_node *new_path(unsigned shift, Args &&...args) {
+    auto lf = std::make_unique<leaf>();
+    std::construct_at(lf->elems, std::forward<Args>(args)...);
+    lf->count = 1;
+    rrb_node *n = lf.release();
+    for (unsigned s = rrb_bits; s <= shift; s += rrb_bits) {
+      rrb_inner *in;
+      try {
+        in = new rrb_inner;
+      } catch (...) {
+        release(n, s - rrb_bits);
+        throw;
+      }
+      in->count = 1;
+      in->children[0] = n;
+      in->sizes[0] = 1;
+      n = in;
+    }
+    return n;
+  }
+
+  template <class... Args>
+  static void push(rrb_node *&slot, unsigned shift, Args &&...args) {
+    if (shift == 0) {
+      auto *lf = unique_leaf(slot);
+      std::construct_at(lf->elems + lf->count, std::forward<Args>(args)...);
+      ++lf->count;
+      return;
+    }
+    auto *in = unique_inner(slot, shift);
+    auto last = in->count - 1;
+    if (has_room(in->children[last], shift - rrb_bits)) {
+      push(in->children[last], shift - rrb_bits, std::forward<Args>(args)...);
+      ++in->sizes[last];
+    } else {
+      in->children[in->count] =
+          new_path(shift - rrb_bits, std::forward<Args>(args)...);
+      in->sizes[in->count] = in->sizes[last] + 1;
+      ++in->count;
+    }
+  }
+
+  static void truncate(rrb_node *&slot, unsigned shift, size_type n) {
+    if (shift == 0) {
+      auto *lf = unique_leaf(slot);
+      std::destroy(lf->elems + n, lf->elems + lf->count);
+      lf->count = static_cast<std::uint32_t>(n);
+      return;
+    }
+    auto *in = unique_inner(slot, shift);
+    auto idx = find_child(in, shift, n - 1);
+    for (auto j = idx + 1; j < in->count; ++j) {
+      release(in->children[j], shift - rrb_bits);
+    }
+    in->count = idx + 1;
+    auto keep = n - (idx != 0 ? in->sizes[idx - 1] : 0);
+    if (subtree_size(in->children[idx], shift - rrb_bits) != keep)
+      truncate(in->children[idx], shift - rrb_bits, keep);
+    in->sizes[idx] = n;
+  }
+
+  static void drop(rrb_node *&slot, unsigned shift, size_type n) {
+    if (shift == 0) {
+      auto *lf = unique_leaf(slot);
+      std::move(lf->elems + n, lf->elems + lf->count, lf->elems);
+      std::destroy(lf->elems + (lf->count - n), lf->elems + lf->count);
+      lf->count -= static_cast<std::uint32_t>(n);
+      return;
+    }
+    auto *in = unique_inner(slot, shift);
+    auto idx = find_child(in, shift, n);
+    for (std::uint32_t j = 0; j < idx; ++j) {
+      release(in->children[j], shift - rrb_bits);
+    }
+    auto skip = n - (idx != 0 ? in->sizes[idx - 1] : 0);
+    for (auto j = idx; j < in->count; ++j) {
+      in->children[j - idx] = in->children[j];
+      in->sizes[j - idx] = in->sizes[j] - n;
+    }
+    in->count -= idx;
+    if (skip != 0)
+      drop(in->children[0], shift - rrb_bits, skip);
+  }
+
+  // drops single-child levels at the top
+  void squeeze() noexcept {
+    while (m_shift != 0 && m_root->count == 1) {
+      auto *child = static_cast<rrb_inner *>(m_root)->children[0];
+      retain(child);
+      release(m_root, m_shift);
+      m_root = child;
+      m_shift -= rrb_bits;
+    }
+  }
+
+  // an inner node at height shift over list.items[first, first + n), whose
+  // references it takes over
+  static rrb_inner *make_inner(node_list &list, std::uint32_t first,
+                               std::uint32_t n, unsigned shift) {
+    auto *in = new rrb_inner;
+    size_type total = 0;
+    for (std::uint32_t i = 0; i < n; ++i) {
+      auto *child = std::exchange(list.items[first + i], nullptr);
+      total += subtree_size(child, shift - rrb_bits);
+      in->children[i] = child;
+      in->sizes[i] = total;
+    }
+    in->count = n;
+    return in;
+  }
+
+  // Keeps the search step invariant: a level may use at most two nodes more
+  // than its slots need. When it uses more, the nodes after the leading full
+  // ones are repacked densely.
+  static void rebalance(node_list &all) {
+    size_type slots = 0;
+    for (std::uint32_t i = 0; i < all.count; ++i) {
+      slots += all.items[i]->count;
+    }
+    auto optimal = (slots + rrb_branches - 1) / rrb_branches;
+    if (all.count <= optimal + 2)
+      return;
+
+    std::uint32_t first = 0;
+    while (all.items[first]->count == rrb_branches)
+      ++first;
+    node_list packed(all.shift);
+    for (auto j = first; j < all.count; ++j) {
+      if (all.shift == 0) {
+        auto *src = static_cast<const leaf *>(all.items[j]);
+        for (std::uint32_t s = 0; s < src->count; ++s) {
+          auto *dst = static_cast<leaf *>(
+              packed.count == 0 ? nullptr : packed.items[packed.count - 1]);
+          if (dst == nullptr || dst->count == rrb_branches) {
+            dst = new leaf;
+            packed.items[packed.count++] = dst;
+          }
+          std::construct_at(dst->elems + dst->count, src->elems[s]);
+          ++dst->count;
+        }
+      } else {
+        auto *src = static_cast<const rrb_inner *>(all.items[j]);
+        for (std::uint32_t s = 0; s < src->count; ++s) {
+          auto *dst = static_cast<rrb_inner *>(
+              packed.count == 0 ? nullptr : packed.items[packed.count - 1]);
+          if (dst == nullptr || dst->count == rrb_branches) {
+            dst = new rrb_inner;
+            packed.items[packed.count++] = dst;
+          }
+          auto *child = src->children[s];
+          retain(child);
+          auto before = dst->count != 0 ? dst->sizes[dst->count - 1] : 0;
+          dst->children[dst->count] = child;
+          dst->sizes[dst->count] =
+              before + subtree_size(child, all.shift - rrb_bits);
+          ++dst->count;
+        }
+      }
+    }
+    for (auto j = first; j < all.count; ++j) {
+      release(std::exchange(all.items[j], nullptr), all.shift);
+    }
+    all.count = first;
+    all.take_all(packed);
+  }
+
+  // children at height shift - 5 into one or two nodes at height shift
+  static node_list pack(node_list &all, unsigned shift) {
+    rebalance(all);
+    node_list out(shift);
+    for (std::uint32_t first = 0; first < all.count; first += rrb_branches) {
+      auto n = std::min(rrb_branches, all.count - first);
+      out.items[out.count++] = make_inner(all, first, n, shift);
+    }
+    all.count = 0;
+    return out;
+  }
+
+  // The trees l and r side by side as one or two nodes at the height of the
+  // taller one; the left tree's right edge and the right tree's left edge
+  // are merged level by level from the bottom up.
+  static node_list merge(rrb_node *l, unsigned lshift, rrb_node *r,
+                         unsigned rshift) {
+    if (lshift > rshift) {
+      auto *in = static_cast<rrb_inner *>(l);
+      auto mid = merge(in->children[in->count - 1], lshift - rrb_bits, r,
+                       rshift);
+      node_list all(lshift - rrb_bits);
+      all.push_shared(in->children, in->count - 1);
+      all.take_all(mid);
+      return pack(all, lshift);
+    }
+    if (rshift > lshift) {
+      auto *in = static_cast<rrb_inner *>(r);
+      auto mid = merge(l, lshift, in->children[0], rshift - rrb_bits);
+      node_list all(rshift - rrb_bits);
+      all.take_all(mid);
+      all.push_shared(in->children + 1, in->count - 1);
+      return pack(all, rshift);
+    }
+    if (lshift == 0) {
+      node_list leaves(0);
+      leaves.push_shared(&l, 1);
+      leaves.push_shared(&r, 1);
+      return leaves;
+    }
+    auto *li = static_cast<rrb_inner *>(l);
+    auto *ri = static_cast<rrb_inner *>(r);
+    auto mid = merge(li->children[li->count - 1], lshift - rrb_bits,
+                     ri->children[0], rshift - rrb_bits);
+    node_list all(lshift - rrb_bits);
+    all.push_shared(li->children, li->count - 1);
+    all.take_all(mid);
+    all.push_shared(ri->children + 1, ri->count - 1);
+    return pack(all, lshift);
+  }
+
+  rrb_node *m_root = nullptr;
+  unsigned m_shift = 0;
+  size_type m_size = 0;
+};
+
+// Reads go through the leaf it found last, so a sequential walk descends
+// the tree once per 32 elements.
+template <class T> class rrb_iterator {
+public:
+  using iterator_category = std::random_access_iterator_tag;
+  using value_type = T;
+  using difference_type = std::ptrdiff_t;
+  using pointer = const T *;
+  using reference = const T &;
+
+  rrb_iterator() = default;
+  rrb_iterator(const rrb_tree<T> *tree, std::size_t index) noexcept
+      : m_tree{tree}, m_index{index} {}
+
+  reference operator*() const noexcept { return *current(); }
+  pointer operator->() const noexcept { return current(); }
+  reference operator[](difference_type n) const noexcept {
+    return *(*this + n);
+  }
+
+  rrb_iterator &operator++() noexcept {
+    ++m_index;
+    return *this;
+  }
+  rrb_iterator operator++(int) noexcept {
+    auto tmp = *this;
+    ++m_index;
+    return tmp;
+  }
+  rrb_iterator &operator--() noexcept {
+    --m_index;
+    return *this;
+  }
+  rrb_iterator operator--(int) noexcept {
+    auto tmp = *this;
+    --m_index;
+    return tmp;
+  }
+  rrb_iterator &operator+=(difference_type n) noexcept {
+    m_index += static_cast<std::size_t>(n);
+    return *this;
+  }
+  rrb_iterator &operator-=(difference_type n) noexcept {
+    m_index -= static_cast<std::size_t>(n);
+    return *this;
+  }
+
+  friend rrb_iterator operator+(rrb_iterator it, difference_type n) noexcept {
+    return it += n;
+  }
+  friend rrb_iterator operator+(difference_type n, rrb_iterator it) noexcept {
+    return it += n;
+  }
+  friend rrb_iterator operator-(rrb_iterator it, difference_type n) noexcept {
+    return it -= n;
+  }
+  friend difference_type operator-(const rrb_iterator &lhs,
+                                   const rrb_iterator &rhs) noexcept {
+    return static_cast<difference_type>(lhs.m_index - rhs.m_index);
+  }
+  friend bool operator==(const rrb_iterator &lhs,
+                         const rrb_iterator &rhs) noexcept {
+    return lhs.m_index == rhs.m_index;
+  }
+  friend auto operator<=>(const rrb_iterator &lhs,
+                          const rrb_iterator &rhs) noexcept {
+    return lhs.m_index <=> rhs.m_index;
+  }
+
+private:
+  const T *current() const noexcept {
+    if (m_index - m_first >= m_count) {
+      auto span = m_tree->find_leaf(m_index);
+      m_elems = span.elems;
+      m_first = span.first;
+      m_count = span.count;
+    }
+    return m_elems + (m_index - m_first);
+  }
+
+  const rrb_tree<T> *m_tree = nullptr;
+  std::size_t m_index = 0;
+  mutable const T *m_elems = nullptr;
+  mutable std::size_t m_first = 0;
+  mutable std::size_t m_count = 0;
+};
+} // namespace detail
+
+// Immutable vector with structural sharing, as a relaxed radix balanced
+// tree of 32-way nodes. Copying is O(1) and every "modifier" returns a new
+// version in O(log32 n), leaving *this untouched; concatenation and slicing
+// are O(log n) as well. Versions share nodes through atomic reference
+// counts, so a version can be handed to other threads and read or dropped
+// there while new versions are made from it.
+//
+// For bulk building, transient() gives a mutable batch that changes nodes
+// in place while nobody else shares them, and persistent() hands out O(1)
+// snapshots of it along the way.
+template <class T> class persistent_vector {
+  using tree = detail::rrb_tree<T>;
+
+public:
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = const T &;
+  using const_reference = const T &;
+  using iterator = detail::rrb_iterator<T>;
+  using const_iterator = detail::rrb_iterator<T>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  // Mutable batch over a persistent_vector. Edits only copy the nodes still
+  // shared with a version handed out before, once each.
+  class transient_type {
+  public:
+    transient_type() = default;
+
+    [[nodiscard]] size_type size() const noexcept { return m_tree.size(); }
+    [[nodiscard]] bool empty() const noexcept { return m_tree.size() == 0; }
+    const T &operator[](size_type i) const noexcept { return m_tree[i]; }
+
+    template <class... Args> void emplace_back(Args &&...args) {
+      m_tree.emplace_back(std::forward<Args>(args)...);
+    }
+    void push_back(const T &value) { m_tree.emplace_back(value); }
+    void push_back(T &&value) { m_tree.emplace_back(std::move(value)); }
+
+    template <class U = T> void set(size_type i, U &&value) {
+      if (i >= size())
+        throw std::out_of_range("my::persistent_vector::transient_type::set");
+      m_tree.assign(i, std::forward<U>(value));
+    }
+
+    void pop_back() { m_tree.truncate(size() - 1); }
+    void append(const persistent_vector &other) { m_tree.append(other.m_tree); }
+
+    // the current contents as a version of their own, in O(1)
+    [[nodiscard]] persistent_vector persistent() const {
+      return persistent_vector(m_tree);
+    }
+
+  private:
+    friend class persistent_vector;
+    explicit transient_type(const tree &t) : m_tree{t} {}
+
+    tree m_tree;
+  };
+
+  // ctor
+  persistent_vector() = default;
+
+  template <std::input_iterator InputIt>
+  persistent_vector(InputIt first, InputIt last) {
+    for (; first != last; ++first) {
+      m_tree.emplace_back(*first);
+    }
+  }
+
+  persistent_vector(std::initializer_list<T> ilist)
+      : persistent_vector(ilist.begin(), ilist.end()) {}
+
+  // element access
+  const T &operator[](size_type i) const noexcept { return m_tree[i]; }
+
+  const T &at(size_type i) const {
+    if (i >= size())
+      throw std::out_of_range("my::persistent_vector::at");
+    return m_tree[i];
+  }
+
+  const T &front() const noexcept { return m_tree[0]; }
+  const T &back() const noexcept { return m_tree[size() - 1]; }
+
+  // iterators
+  const_iterator begin() const noexcept { return {&m_tree, 0}; }
+  const_iterator cbegin() const noexcept { return begin(); }
+  const_iterator end() const noexcept { return {&m_tree, size()}; }
+  const_iterator cend() const noexcept { return end(); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // capacity
+  [[nodiscard]] size_type size() const noexcept { return m_tree.size(); }
+  [[nodiscard]] bool empty() const noexcept { return size() == 0; }
+
+  // new versions
+  template <class... Args>
+  [[nodiscard]] persistent_vector emplace_back(Args &&...args) const {
+    auto next = *this;
+    next.m_tree.emplace_back(std::forward<Args>(args)...);
+    return next;
+  }
+  [[nodiscard]] persistent_vector push_back(const T &value) const {
+    return emplace_back(value);
+  }
+  [[nodiscard]] persistent_vector push_back(T &&value) const {
+    return emplace_back(std::move(value));
+  }
+
+  template <class U = T>
+  [[nodiscard]] persistent_vector set(size_type i, U &&value) const {
+    if (i >= size())
+      throw std::out_of_range("my::persistent_vector::set");
+    auto next = *this;
+    next.m_tree.assign(i, std::forward<U>(value));
+    return next;
+  }
+
+  [[nodiscard]] persistent_vector pop_back() const { return take(size() - 1); }
+
+  // the first n elements
+  [[nodiscard]] persistent_vector take(size_type n) const {
+    auto next = *this;
+    next.m_tree.truncate(n);
+    return next;
+  }
+
+  // all but the first n elements
+  [[nodiscard]] persistent_vector drop(size_type n) const {
+    auto next = *this;
+    next.m_tree.drop_front(n);
+    return next;
+  }
+
+  // the elements in [first, last)
+  [[nodiscard]] persistent_vector slice(size_type first, size_type last) const {
+    if (first > last || last > size())
+      throw std::out_of_range("my::persistent_vector::slice");
+    auto next = *this;
+    next.m_tree.truncate(last);
+    next.m_tree.drop_front(first);
+    return next;
+  }
+
+  [[nodiscard]] persistent_vector concat(const persistent_vector &other) const {
+    auto next = *this;
+    next.m_tree.append(other.m_tree);
+    return next;
+  }
+
+  friend persistent_vector operator+(const persistent_vector &lhs,
+                                     const persistent_vector &rhs) {
+    return lhs.concat(rhs);
+  }
+
+  [[nodiscard]] transient_type transient() const {
+    return transient_type(m_tree);
+  }
+
+  void swap(persistent_vector &other) noexcept { m_tree.swap(other.m_tree); }
+
+  friend bool operator==(const persistent_vector &lhs,
+                         const persistent_vector &rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+  }
+
+  friend auto operator<=>(const persistent_vector &lhs,
+                          const persistent_vector &rhs) {
+    return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(),
+                                                  rhs.begin(), rhs.end());
+  }
+
+private:
+  explicit persistent_vector(const tree &t) : m_tree{t} {}
+
+  tree m_tree;
+};
+
+template <class T>
+void swap(persistent_vector<T> &lhs, persistent_vector<T> &rhs) noexcept {
+  lhs.swap(rhs);
+}
+} // namespace my
@@ -0,0 +1,247 @@
+#pragma once
+#include <algorithm>
+#include <cstddef>
+#include <limits>
+#include <mutex>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+namespace detail {
+
+// a free block, linked through its own first bytes
+struct free_block {
+  free_block *next;
+};
+
+// Blocks of one size and alignment carved out of slabs, shared by every
+// thread. The pool is never destroyed and never gives slabs back: blocks may
+// still come home from thread_local destructors or from containers with
+// static storage duration after static destructors have run.
+template <std::size_t Size, std::size_t Align> class node_pool {
+public:
+  static constexpr std::size_t block_align =
+      std::max(Align, alignof(free_block));
+  static constexpr std::size_t block_size =
+      (std::max(Size, sizeof(free_block)) + block_align - 1) / block_align *
+      block_align;
+  static constexpr std::size_t slab_bytes = std::size_t{64} << 10;
+  static constexpr std::size_t blocks_per_slab =
+      std::max<std::size_t>(slab_bytes / block_size, 16);
+
+  static node_pool &instance() {
+    static auto *pool = new node_pool;
+    return *pool;
+  }
+
+  void *allocate() {
+    std::lock_guard lock{m_mutex};
+    if (m_free == nullptr)
+      grow();
+    return std::exchange(m_free, m_free->next);
+  }
+
+  void deallocate(void *p) noexcept {
+    auto *block = static_cast<free_block *>(p);
+    std::lock_guard lock{m_mutex};
+    block->next = m_free;
+    m_free = block;
+  }
+
+  // moves up to n blocks, at least one, onto the front of chain; a new slab
+  // is only made when there is nothing left to move
+  std::size_t take(free_block *&chain, std::size_t n) {
+    std::lock_guard lock{m_mutex};
+    if (m_free == nullptr)
+      grow();
+    // the run keeps its order, so the cache hands blocks out in address
+    // order too
+    free_block *first = m_free;
+    free_block *last = first;
+    std::size_t moved = 1;
+    for (; moved != n && last->next != nullptr; ++moved) {
+      last = last->next;
+    }
+    m_free = last->next;
+    last->next = chain;
+    chain = first;
+    return moved;
+  }
+
+  // hands back the blocks linked from first to last
+  void give(free_block *first, free_block *last) noexcept {
+    std::lock_guard lock{m_mutex};
+    last->next = m_free;
+    m_free = first;
+  }
+
+  [[nodiscard]] std::size_t slab_count() {
+    std::lock_guard lock{m_mutex};
+    return m_slabs;
+  }
+
+private:
+  node_pool() = default;
+
+  // links a new slab's blocks in address order, so that a burst of
+  // allocations walks through memory front to back
+  void grow() {
+    auto *slab = static_cast<std::byte *>(::operator new(
+        block_size * blocks_per_slab, std::align_val_t{block_align}));
+    free_block *head = m_free;
+    for (auto i = blocks_per_slab; i != 0; --i) {
+      auto *block =
+          reinterpret_cast<free_block *>(slab + (i - 1) * block_size);
+      block->next = head;
+      head = block;
+    }
+    m_free = head;
+    ++m_slabs;
+  }
+
+  std::mutex m_mutex;
+  free_block *m_free = nullptr;
+  std::size_t m_slabs = 0;
+};
+
+// A thread's private stack of free blocks in front of a node_pool: it refills
+// and drains in batches, so the pool's lock is taken once per batch.
+template <std::size_t Size, std::size_t Align> class node_cache {
+  using pool = node_pool<Size, Align>;
+
+public:
+  static constexpr std::size_t batch = 64;
+
+  static void *allocate() {
+    if (t_gone)
+      return pool::instance().allocate();
+    auto &cache = local();
+    if (cache.m_free == nullptr) {
+      cache.m_count = pool::instance().take(cache.m_free, batch);
+    }
+    --cache.m_count;
+    return std::exchange(cache.m_free, cache.m_free->next);
+  }
+
+  static void deallocate(void *p) noexcept {
+    if (t_gone) {
+      pool::instance().deallocate(p);
+      return;
+    }
+    auto &cache = local();
+    auto *block = static_cast<free_block *>(p);
+    block->next = cache.m_free;
+    cache.m_free = block;
+    if (++cache.m_count > 2 * batch)
+      cache.flush(batch);
+  }
+
+  ~node_cache() {
+    flush(m_count);
+    t_gone = true;
+  }
+
+private:
+  node_cache() = default;
+
+  static node_cache &local() noexcept {
+    thread_local node_cache cache;
+    return cache;
+  }
+
+  void flush(std::size_t n) noexcept {
+    if (n == 0)
+      return;
+    free_block *first = m_free;
+    free_block *last = first;
+    for (std::size_t i = 1; i < n; ++i) {
+      last = last->next;
+    }
+    m_free = last->next;
+    m_count -= n;
+    pool::instance().give(first, last);
+  }
+
+  // set once the cache of this thread is destroyed; later frees on the same
+  // thread (static destructors) go straight to the pool
+  static inline thread_local bool t_gone = false;
+
+  free_block *m_free = nullptr;
+  std::size_t m_count = 0;
+};
+} // namespace detail
+
+// Allocator for node-based containers. Single objects come from a pool of
+// sizeof(T)-byte blocks, carved out of 64 KiB slabs and recycled through an
+// intrusive free list, so nodes cost one call into operator new per slab
+// instead of one each and sit next to each other in memory. All
+// pool_allocators with the same block size and alignment share one pool, and
+// freed blocks go back to it, not to the system.
+//
+// With ThreadCache each thread keeps up to 128 free blocks of its own and
+// takes the pool's lock once per 64 allocations or frees; without it every
+// call takes the lock. Arrays (n != 1) bypass the pool.
+template <class T, bool ThreadCache = true> struct pool_allocator {
+  using value_type = T;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using propagate_on_container_move_assignment = std::true_type;
+  using is_always_equal = std::true_type;
+
+  template <class U> struct rebind {
+    using other = pool_allocator<U, ThreadCache>;
+  };
+
+  constexpr pool_allocator() noexcept = default;
+  template <class U>
+  constexpr pool_allocator(const pool_allocator<U, ThreadCache> &) noexcept {}
+
+  [[nodiscard]] pointer allocate(size_type n) {
+    if (n != 1) {
+      if (n > std::numeric_limits<size_type>::max() / sizeof(T))
+        throw std::bad_array_new_length();
+      return static_cast<pointer>(
+          ::operator new(n * sizeof(T), std::align_val_t{alignof(T)}));
+    }
+    if constexpr (ThreadCache) {
+      return static_cast<pointer>(cache::allocate());
+    } else {
+      return static_cast<pointer>(pool::instance().allocate());
+    }
+  }
+
+  void deallocate(pointer p, size_type n) noexcept {
+    if (p == nullptr)
+      return;
+    if (n != 1) {
+      ::operator delete(p, std::align_val_t{alignof(T)});
+      return;
+    }
+    if constexpr (ThreadCache) {
+      cache::deallocate(p);
+    } else {
+      pool::instance().deallocate(p);
+    }
+  }
+
+  // slabs the pool behind this allocator has taken from operator new so far
+  [[nodiscard]] static std::size_t slab_count() {
+    return pool::instance().slab_count();
+  }
+
+  template <class U>
+  friend constexpr bool
+  operator==(const pool_allocator &,
+             const pool_allocator<U, ThreadCache> &) noexcept {
+    return true;
+  }
+
+private:
+  using pool = detail::node_pool<sizeof(T), alignof(T)>;
+  using cache = detail::node_cache<sizeof(T), alignof(T)>;
+};
+} // namespace my
@@ -0,0 +1,348 @@
+#pragma once
+#include "list.h"
+#include "vector.h"
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/uio.h>
+#include <unistd.h>
+
+// Binary serialization of my containers over POSIX file descriptors.
+//
+// A container is written as a 64-bit element count followed by its elements,
+// in native byte order. Element types opt in through my::serializer<T>:
+// trivially copyable types are handled bitwise, and anything else provides a
+// specialization with static write(binary_writer&, const T&) and
+// read(binary_reader&, T&).
+//
+// binary_writer collects small writes in a reusable buffer and hands large
+// contiguous payloads (the data of a vector of trivially copyable elements) to
+// writev in place, so serialize(fd, a, b, c) of three such vectors is a single
+// writev of headers and element arrays with no copy of the elements.
+// binary_reader reads large payloads straight into their destination, after
+// the container has reserved room for the count in the header.
+
+#ifndef IOV_MAX
+#define IOV_MAX 1024
+#endif
+
+namespace my {
+
+class binary_writer;
+class binary_reader;
+
+template <class T> struct serializer;
+
+// bitwise: the object representation is the serialized form
+template <class T>
+  requires std::is_trivially_copyable_v<T>
+struct serializer<T> {
+  static constexpr bool bitwise = true;
+
+  static void write(binary_writer &w, const T &value);
+  static void read(binary_reader &r, T &value);
+};
+
+namespace detail {
+template <class T>
+concept bitwise_serializable = requires {
+  requires serializer<T>::bitwise;
+};
+
+[[noreturn]] inline void throw_io_errno(const char *what) {
+  throw std::system_error(errno, std::generic_category(), what);
+}
+} // namespace detail
+
+class binary_writer {
+public:
+  static constexpr std::size_t default_buffer_size = std::size_t{1} << 16;
+  // payloads at least this large are passed to writev where they are instead
+  // of being copied into the buffer
+  static constexpr std::size_t zero_copy_threshold = 4096;
+
+  explicit binary_writer(int fd, std::size_t buffer_size = default_buffer_size)
+      : m_fd{fd},
+        m_buffer(default_init, std::max(buffer_size, zero_copy_threshold)) {}
+
+  binary_writer(const binary_writer &) = delete;
+  binary_writer &operator=(const binary_writer &) = delete;
+
+  // best effort: call flush() to see write errors
+  ~binary_writer() {
+    try {
+      flush();
+    } catch (...) {
+    }
+  }
+
+  // Large payloads are referenced, not copied: p must stay valid and
+  // unchanged until the next flush().
+  void write_bytes(const void *p, std::size_t n) {
+    // empty payloads may come with a null pointer, as from an empty vector
+    if (n == 0)
+      return;
+    if (n >= zero_copy_threshold) {
+      seal();
+      m_iov.push_back({const_cast<void *>(p), n});
+      if (m_iov.size() >= IOV_MAX) {
+        flush();
+      }
+      return;
+    }
+    if (m_used + n > m_buffer.size()) {
+      flush();
+    }
+    std::memcpy(m_buffer.data() + m_used, p, n);
+    m_used += n;
+  }
+
+  template <class T> void write(const T &value) {
+    serializer<T>::write(*this, value);
+  }
+
+  void write_length(std::size_t n) { write(static_cast<std::uint64_t>(n)); }
+
+  // writes everything queued so far, IOV_MAX segments per writev
+  void flush() {
+    seal();
+    std::size_t i = 0;
+    while (i < m_iov.size()) {
+      auto count = std::min<std::size_t>(m_iov.size() - i, IOV_MAX);
+      auto written = ::writev(m_fd, m_iov.data() + i, static_cast<int>(count));
+      if (written < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        detail::throw_io_errno("my::binary_writer: writev");
+      }
+      // skip what went out, a short write resumes inside a segment
+      auto done = static_cast<std::size_t>(written);
+      while (i < m_iov.size() && done >= m_iov[i].iov_len) {
+        done -= m_iov[i].iov_len;
+        ++i;
+      }
+      if (done > 0) {
+        m_iov[i].iov_base = static_cast<char *>(m_iov[i].iov_base) + done;
+        m_iov[i].iov_len -= done;
+      }
+    }
+    m_iov.clear();
+    m_used = m_sealed = 0;
+  }
+
+private:
+  // queues the buffered bytes not yet queued, so later payloads keep order
+  void seal() {
+    if (m_used > m_sealed) {
+      m_iov.push_back({m_buffer.data() + m_sealed, m_used - m_sealed});
+      m_sealed = m_used;
+    }
+  }
+
+  int m_fd;
+  vector<std::byte> m_buffer;
+  std::size_t m_used = 0;   // bytes in m_buffer
+  std::size_t m_sealed = 0; // bytes of m_buffer already in m_iov
+  vector<iovec> m_iov;
+};
+
+// Reads ahead into its buffer, so use one reader per stream.
+class binary_reader {
+public:
+  static constexpr std::size_t default_buffer_size = std::size_t{1} << 16;
+
+  explicit binary_reader(int fd, std::size_t buffer_size = default_buffer_size)
+      : m_fd{fd}, m_buffer(default_init, std::max<std::size_t>(buffer_size, 64)) {
+  }
+
+  binary_reader(const binary_reader &) = delete;
+  binary_reader &operator=(const binary_reader &) = delete;
+
+  void read_bytes(void *p, std::size_t n) {
+    if (n == 0)
+      return;
+    auto *out = static_cast<std::byte *>(p);
+    auto buffered = m_end - m_pos;
+    if (n <= buffered) {
+      std::memcpy(out, m_buffer.data() + m_pos, n);
+      m_pos += n;
+      return;
+    }
+    if (buffered != 0) {
+      std::memcpy(out, m_buffer.data() + m_pos, buffered);
+      out += buffered;
+      n -= buffered;
+    }
+    m_pos = m_end = 0;
+    if (n >= m_buffer.size()) {
+      // too big to stage: read the rest in place
+      if (fill(out, n, n) < n) {
+        throw std::runtime_error("my::binary_reader: unexpected end of input");
+      }
+      return;
+    }
+    m_end = fill(m_buffer.data(), n, m_buffer.size());
+    if (m_end < n) {
+      throw std::runtime_error("my::binary_reader: unexpected end of input");
+    }
+    std::memcpy(out, m_buffer.data(), n);
+    m_pos = n;
+  }
+
+  template <class T> void read(T &value) { serializer<T>::read(*this, value); }
+
+  template <class T> T read() {
+    T value;
+    read(value);
+    return value;
+  }
+
+  std::size_t read_length() {
+    auto n = read<std::uint64_t>();
+    if (n > PTRDIFF_MAX) {
+      throw std::length_error("my::binary_reader: length header is too large");
+    }
+    return static_cast<std::size_t>(n);
+  }
+
+private:
+  // reads at least `min` and at most `max` bytes into p, fewer only at EOF
+  std::size_t fill(std::byte *p, std::size_t min, std::size_t max) {
+    std::size_t got = 0;
+    while (got < min) {
+      auto r = ::read(m_fd, p + got, max - got);
+      if (r < 0) {
+        if (errno == EINTR) {
+          continue;
+        }
+        detail::throw_io_errno("my::binary_reader: read");
+      }
+      if (r == 0) {
+        break;
+      }
+      got += static_cast<std::size_t>(r);
+    }
+    return got;
+  }
+
+  int m_fd;
+  vector<std::byte> m_buffer;
+  std::size_t m_pos = 0;
+  std::size_t m_end = 0;
+};
+
+template <class T>
+  requires std::is_trivially_copyable_v<T>
+void serializer<T>::write(binary_writer &w, const T &value) {
+  w.write_bytes(std::addressof(value), sizeof(T));
+}
+
+template <class T>
+  requires std::is_trivially_copyable_v<T>
+void serializer<T>::read(binary_reader &r, T &value) {
+  r.read_bytes(std::addressof(value), sizeof(T));
+}
+
+template <class CharT, class Traits, class Alloc>
+struct serializer<std::basic_string<CharT, Traits, Alloc>> {
+  using string_type = std::basic_string<CharT, Traits, Alloc>;
+
+  static void write(binary_writer &w, const string_type &s) {
+    w.write_length(s.size());
+    w.write_bytes(s.data(), s.size() * sizeof(CharT));
+  }
+  static void read(binary_reader &r, string_type &s) {
+    s.resize(r.read_length());
+    r.read_bytes(s.data(), s.size() * sizeof(CharT));
+  }
+};
+
+template <class T, class Alloc, class Growth>
+struct serializer<vector<T, Alloc, Growth>> {
+  using vector_type = vector<T, Alloc, Growth>;
+
+  static void write(binary_writer &w, const vector_type &v) {
+    w.write_length(v.size());
+    if constexpr (detail::bitwise_serializable<T>) {
+      w.write_bytes(v.data(), v.size() * sizeof(T));
+    } else {
+      for (const auto &e : v) {
+        w.write(e);
+      }
+    }
+  }
+  static void read(binary_reader &r, vector_type &v) {
+    auto n = r.read_length();
+    v.clear();
+    if constexpr (detail::bitwise_serializable<T>) {
+      v.resize_for_overwrite(n);
+      r.read_bytes(v.data(), n * sizeof(T));
+    } else {
+      v.reserve(n);
+      for (std::size_t i = 0; i < n; ++i) {
+        r.read(v.emplace_back());
+      }
+    }
+  }
+};
+
+// the packed words as they are, tail bits included (always zero)
+template <class Alloc, class Growth>
+struct serializer<vector<bool, Alloc, Growth>> {
+  using vector_type = vector<bool, Alloc, Growth>;
+  using word_type = typename vector_type::word_type;
+
+  static void write(binary_writer &w, const vector_type &v) {
+    w.write_length(v.size());
+    w.write_bytes(v.words(), v.word_count() * sizeof(word_type));
+  }
+  static void read(binary_reader &r, vector_type &v) {
+    auto n = r.read_length();
+    v.clear();
+    v.resize(n);
+    r.read_bytes(v.words(), v.word_count() * sizeof(word_type));
+    if (auto tail = n % vector_type::bits_per_word; tail != 0) {
+      v.words()[v.word_count() - 1] &= (word_type{1} << tail) - 1;
+    }
+  }
+};
+
+// nodes are not contiguous, elements go through the writer's buffer
+template <class T, class A> struct serializer<list<T, A>> {
+  static void write(binary_writer &w, const list<T, A> &l) {
+    w.write_length(l.size());
+    for (const auto &e : l) {
+      w.write(e);
+    }
+  }
+  static void read(binary_reader &r, list<T, A> &l) {
+    auto n = r.read_length();
+    l.clear();
+    for (std::size_t i = 0; i < n; ++i) {
+      r.read(l.emplace_back());
+    }
+  }
+};
+
+// writes values to fd back to back, with one writev where possible
+template <class... Ts> void serialize(int fd, const Ts &...values) {
+  binary_writer w(fd);
+  (w.write(values), ...);
+  w.flush();
+}
+
+template <class... Ts> void deserialize(int fd, Ts &...values) {
+  binary_reader r(fd);
+  (r.read(values), ...);
+}
+} // namespace my
@@ -0,0 +1,365 @@
+#pragma once
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+#if defined(__x86_64__) || defined(__i386__)
+#define MY_SIMD_X86 1
+#include <immintrin.h>
+#endif
+
+// Vectorized kernels for element-wise passes over contiguous arrays. Every
+// kernel has a portable scalar version; on x86 wider SSE2/AVX2/AVX-512
+// versions are compiled with target attributes and picked at runtime from
+// what the CPU reports, so no -m flags are needed to get them.
+
+namespace my::detail::simd {
+
+enum class isa { scalar, sse2, avx2, avx512 };
+
+inline isa best_isa() noexcept {
+#if defined(MY_SIMD_X86)
+  static const isa level = [] {
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw"))
+      return isa::avx512;
+    if (__builtin_cpu_supports("avx2"))
+      return isa::avx2;
+    if (__builtin_cpu_supports("sse2"))
+      return isa::sse2;
+    return isa::scalar;
+  }();
+  return level;
+#else
+  return isa::scalar;
+#endif
+}
+
+// element types the kernels below handle: integers are compared bytewise,
+// float and double with floating-point equality (NaN never matches)
+template <class T>
+concept comparable =
+    std::is_integral_v<T> || std::is_same_v<T, float> ||
+    std::is_same_v<T, double>;
+
+// first_mismatch: index of the first i with !(a[i] == b[i]), or n
+
+inline std::size_t mismatch_bytes_scalar(const unsigned char *a,
+                                         const unsigned char *b,
+                                         std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    std::uint64_t x;
+    std::uint64_t y;
+    std::memcpy(&x, a + i, 8);
+    std::memcpy(&y, b + i, 8);
+    if (x != y)
+      break;
+  }
+  for (; i < n; ++i) {
+    if (a[i] != b[i])
+      return i;
+  }
+  return n;
+}
+
+template <class F>
+std::size_t mismatch_float_scalar(const F *a, const F *b,
+                                  std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; ++i) {
+    if (!(a[i] == b[i]))
+      return i;
+  }
+  return n;
+}
+
+#if defined(MY_SIMD_X86)
+__attribute__((target("sse2"))) inline std::size_t
+mismatch_bytes_sse2(const unsigned char *a, const unsigned char *b,
+                    std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 16 <= n; i += 16) {
+    auto x = _mm_loadu_si128(reinterpret_cast<const __m128i *>(a + i));
+    auto y = _mm_loadu_si128(reinterpret_cast<const __m128i *>(b + i));
+    auto ne = static_cast<unsigned>(_mm_movemask_epi8(_mm_cmpeq_epi8(x, y))) ^
+              0xFFFFu;
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return i + mismatch_bytes_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline std::size_t
+mismatch_bytes_avx2(const unsigned char *a, const unsigned char *b,
+                    std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 32 <= n; i += 32) {
+    auto x = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(a + i));
+    auto y = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(b + i));
+    auto ne =
+        ~static_cast<unsigned>(_mm256_movemask_epi8(_mm256_cmpeq_epi8(x, y)));
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return i + mismatch_bytes_sse2(a + i, b + i, n - i);
+}
+
+// the tail is handled with a masked load instead of a scalar loop
+__attribute__((target("avx512f,avx512bw"))) inline std::size_t
+mismatch_bytes_avx512(const unsigned char *a, const unsigned char *b,
+                      std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; i += 64) {
+    __mmask64 k = n - i >= 64 ? ~__mmask64{0} : (__mmask64{1} << (n - i)) - 1;
+    auto x = _mm512_maskz_loadu_epi8(k, a + i);
+    auto y = _mm512_maskz_loadu_epi8(k, b + i);
+    auto ne = _mm512_mask_cmpneq_epi8_mask(k, x, y);
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctzll(ne));
+  }
+  return n;
+}
+
+__attribute__((target("sse2"))) inline std::size_t
+mismatch_float_sse2(const float *a, const float *b, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto ne = _mm_movemask_ps(_mm_cmpneq_ps(_mm_loadu_ps(a + i),
+                                            _mm_loadu_ps(b + i)));
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return i + mismatch_float_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("sse2"))) inline std::size_t
+mismatch_float_sse2(const double *a, const double *b, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 2 <= n; i += 2) {
+    auto ne = _mm_movemask_pd(_mm_cmpneq_pd(_mm_loadu_pd(a + i),
+                                            _mm_loadu_pd(b + i)));
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return i + mismatch_float_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline std::size_t
+mismatch_float_avx2(const float *a, const float *b, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 8 <= n; i += 8) {
+    auto ne = _mm256_movemask_ps(_mm256_cmp_ps(
+        _mm256_loadu_ps(a + i), _mm256_loadu_ps(b + i), _CMP_NEQ_UQ));
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return i + mismatch_float_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx2"))) inline std::size_t
+mismatch_float_avx2(const double *a, const double *b, std::size_t n) noexcept {
+  std::size_t i = 0;
+  for (; i + 4 <= n; i += 4) {
+    auto ne = _mm256_movemask_pd(_mm256_cmp_pd(
+        _mm256_loadu_pd(a + i), _mm256_loadu_pd(b + i), _CMP_NEQ_UQ));
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return i + mismatch_float_scalar(a + i, b + i, n - i);
+}
+
+__attribute__((target("avx512f"))) inline std::size_t
+mismatch_float_avx512(const float *a, const float *b, std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; i += 16) {
+    __mmask16 k = n - i >= 16 ? __mmask16(0xFFFF)
+                              : static_cast<__mmask16>((1u << (n - i)) - 1);
+    auto ne = _mm512_mask_cmp_ps_mask(k, _mm512_maskz_loadu_ps(k, a + i),
+                                      _mm512_maskz_loadu_ps(k, b + i),
+                                      _CMP_NEQ_UQ);
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return n;
+}
+
+__attribute__((target("avx512f"))) inline std::size_t
+mismatch_float_avx512(const double *a, const double *b,
+                      std::size_t n) noexcept {
+  for (std::size_t i = 0; i < n; i += 8) {
+    __mmask8 k = n - i >= 8 ? __mmask8(0xFF)
+                            : static_cast<__mmask8>((1u << (n - i)) - 1);
+    auto ne = _mm512_mask_cmp_pd_mask(k, _mm512_maskz_loadu_pd(k, a + i),
+                                      _mm512_maskz_loadu_pd(k, b + i),
+                                      _CMP_NEQ_UQ);
+    if (ne != 0)
+      return i + static_cast<std::size_t>(__builtin_ctz(ne));
+  }
+  return n;
+}
+#endif
+
+inline std::size_t mismatch_bytes(const void *a, const void *b,
+                                  std::size_t n) noexcept {
+  auto *x = static_cast<const unsigned char *>(a);
+  auto *y = static_cast<const unsigned char *>(b);
+  switch (best_isa()) {
+#if defined(MY_SIMD_X86)
+  case isa::avx512:
+    return mismatch_bytes_avx512(x, y, n);
+  case isa::avx2:
+    return mismatch_bytes_avx2(x, y, n);
+  case isa::sse2:
+    return mismatch_bytes_sse2(x, y, n);
+#endif
+  default:
+    return mismatch_bytes_scalar(x, y, n);
+  }
+}
+
+template <comparable T>
+std::size_t first_mismatch(const T *a, const T *b, std::size_t n) noexcept {
+  if constexpr (std::is_integral_v<T>) {
+    return mismatch_bytes(a, b, n * sizeof(T)) / sizeof(T);
+  } else {
+    switch (best_isa()) {
+#if defined(MY_SIMD_X86)
+    case isa::avx512:
+      return mismatch_float_avx512(a, b, n);
+    case isa::avx2:
+      return mismatch_float_avx2(a, b, n);
+    case isa::sse2:
+      return mismatch_float_sse2(a, b, n);
+#endif
+    default:
+      return mismatch_float_scalar(a, b, n);
+    }
+  }
+}
+
+template <comparable T>
+bool equal(const T *a, std::size_t n, const T *b, std::size_t m) noexcept {
+  return n == m && first_mismatch(a, b, n) == n;
+}
+
+// lexicographical three-way comparison: vector scan for the first differing
+// element, then one scalar <=> on it
+template <comparable T>
+std::compare_three_way_result_t<T> compare_three_way(const T *a, std::size_t n,
+                                                     const T *b,
+                                                     std::size_t m) noexcept {
+  auto common = n < m ? n : m;
+  auto i = first_mismatch(a, b, common);
+  if (i != common)
+    return a[i] <=> b[i];
+  return n <=> m;
+}
+
+// Stream compaction: moves the elements of [data, data + n) that keep()
+// accepts to the front, in order, and returns how many there are. keep is
+// called exactly once per element, front to back. The vector kernels gather
+// a block's keep bits into a mask and write the survivors with one
+// compress (AVX-512) or table driven permute (AVX2) and a full-width store,
+// which only ever lands on elements that were already read.
+template <class T>
+concept compactable = std::is_trivially_copyable_v<T> &&
+                      (sizeof(T) == 4 || sizeof(T) == 8);
+
+template <class T, class Keep>
+std::size_t compact_scalar(T *data, std::size_t i, std::size_t out,
+                           std::size_t n, Keep &keep) {
+  for (; i < n; ++i) {
+    bool k = keep(data[i]);
+    std::memmove(static_cast<void *>(data + out),
+                 static_cast<const void *>(data + i), sizeof(T));
+    out += k;
+  }
+  return out;
+}
+
+template <class T, class Keep>
+unsigned keep_mask(const T *block, std::size_t lanes, Keep &keep) {
+  unsigned mask = 0;
+  for (std::size_t j = 0; j < lanes; ++j) {
+    mask |= static_cast<unsigned>(static_cast<bool>(keep(block[j]))) << j;
+  }
+  return mask;
+}
+
+#if defined(MY_SIMD_X86)
+// permutevar8x32 indices that pack the kept lanes of an 8 x 32-bit register
+template <std::size_t Lanes> struct compress_table {
+  alignas(32) std::uint32_t idx[1u << Lanes][8]{};
+
+  constexpr compress_table() {
+    constexpr std::size_t width = 8 / Lanes;
+    for (std::size_t m = 0; m < (1u << Lanes); ++m) {
+      std::size_t k = 0;
+      for (std::size_t lane = 0; lane < Lanes; ++lane) {
+        if ((m >> lane & 1) == 0)
+          continue;
+        for (std::size_t w = 0; w < width; ++w) {
+          idx[m][k++] = static_cast<std::uint32_t>(lane * width + w);
+        }
+      }
+    }
+  }
+};
+
+template <std::size_t Lanes>
+inline constexpr compress_table<Lanes> compress_lut{};
+
+template <class T, class Keep>
+__attribute__((target("avx2"))) std::size_t
+compact_avx2(T *data, std::size_t n, Keep &keep) {
+  constexpr std::size_t lanes = 32 / sizeof(T);
+  std::size_t out = 0;
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto mask = keep_mask(data + i, lanes, keep);
+    auto v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+    auto idx = _mm256_load_si256(
+        reinterpret_cast<const __m256i *>(compress_lut<lanes>.idx[mask]));
+    _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + out),
+                        _mm256_permutevar8x32_epi32(v, idx));
+    out += static_cast<std::size_t>(std::popcount(mask));
+  }
+  return compact_scalar(data, i, out, n, keep);
+}
+
+template <class T, class Keep>
+__attribute__((target("avx512f"))) std::size_t
+compact_avx512(T *data, std::size_t n, Keep &keep) {
+  constexpr std::size_t lanes = 64 / sizeof(T);
+  std::size_t out = 0;
+  std::size_t i = 0;
+  for (; i + lanes <= n; i += lanes) {
+    auto mask = keep_mask(data + i, lanes, keep);
+    auto v = _mm512_loadu_si512(data + i);
+    if constexpr (sizeof(T) == 4) {
+      v = _mm512_maskz_compress_epi32(static_cast<__mmask16>(mask), v);
+    } else {
+      v = _mm512_maskz_compress_epi64(static_cast<__mmask8>(mask), v);
+    }
+    _mm512_storeu_si512(data + out, v);
+    out += static_cast<std::size_t>(std::popcount(mask));
+  }
+  return compact_scalar(data, i, out, n, keep);
+}
+#endif
+
+template <compactable T, class Keep>
+std::size_t compact(T *data, std::size_t n, Keep keep) {
+  switch (best_isa()) {
+#if defined(MY_SIMD_X86)
+  case isa::avx512:
+    return compact_avx512(data, n, keep);
+  case isa::avx2:
+    return compact_avx2(data, n, keep);
+#endif
+  default:
+    return compact_scalar(data, 0, 0, n, keep);
+  }
+}
+} // namespace my::detail::simd
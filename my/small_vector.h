@@ -0,0 +1,510 @@
+#pragma once
+#include "vector.h"
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <utility>
+
+namespace my {
+
+// A vector that keeps its first N elements inside the object and only goes to
+// the allocator once it outgrows them. Insertion and growth share the
+// algorithms of my::vector.
+template <class T, std::size_t N, class Allocator = allocator<T>,
+          growth_policy Growth = default_growth>
+class small_vector {
+  static_assert(N > 0, "my::small_vector: inline capacity must be non-zero");
+
+public:
+  using value_type = T;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using pointer = T *;
+  using const_pointer = const T *;
+  using reference = T &;
+  using const_reference = const T &;
+  using iterator = T *;
+  using const_iterator = const T *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  using alloc_traits = std::allocator_traits<allocator_type>;
+
+  static constexpr size_type grow_capacity(size_type cap, size_type required) {
+    return Growth::next_capacity(cap, required, sizeof(T));
+  }
+
+  allocation_result<pointer> allocate(size_type n) {
+    if constexpr (requires(allocator_type &a) { a.allocate_at_least(n); }) {
+      auto [ptr, count] = m_alloc.allocate_at_least(n);
+      return {ptr, count};
+    } else {
+      return {alloc_traits::allocate(m_alloc, n), n};
+    }
+  }
+
+  // the inline buffer is never handed back to the allocator
+  void deallocate(pointer p, size_type n) {
+    if (p != nullptr && p != inline_data())
+      alloc_traits::deallocate(m_alloc, p, n);
+  }
+
+  pointer inline_data() noexcept {
+    return reinterpret_cast<pointer>(m_inline);
+  }
+  const_pointer inline_data() const noexcept {
+    return reinterpret_cast<const_pointer>(m_inline);
+  }
+
+  // swaps the buffer for new_data, which already holds the elements
+  void adopt(pointer new_data, size_type new_cap) {
+    deallocate(m_data, m_capacity);
+    m_data = new_data;
+    m_capacity = new_cap;
+  }
+
+  // moves the elements of other into our (large enough) buffer and leaves
+  // other empty and inline, or steals its heap buffer when it has one
+  void take(small_vector &other) {
+    if (other.is_inline()) {
+      detail::relocate(other.begin(), other.end(), m_data);
+      m_size = other.m_size;
+    } else {
+      adopt(other.m_data, other.m_capacity);
+      m_size = other.m_size;
+      other.m_data = other.inline_data();
+      other.m_capacity = N;
+    }
+    other.m_size = 0;
+  }
+
+  pointer m_data;
+  size_type m_size;
+  size_type m_capacity;
+  [[no_unique_address]] allocator_type m_alloc;
+  alignas(T) std::byte m_inline[N * sizeof(T)];
+
+public:
+  // ctor
+  small_vector() noexcept(noexcept(Allocator())) : small_vector(Allocator()) {}
+  explicit small_vector(const Allocator &alloc) noexcept
+      : m_data{inline_data()}, m_size{}, m_capacity{N}, m_alloc{alloc} {}
+  explicit small_vector(size_type count, const Allocator &alloc = Allocator())
+      : small_vector(count, T{}, alloc) {}
+  small_vector(size_type count, const_reference value,
+               const Allocator &alloc = Allocator())
+      : small_vector(alloc) {
+    reserve(count);
+    std::uninitialized_fill_n(m_data, count, value);
+    m_size = count;
+  }
+
+  template <container_compatible_range<T> R>
+  small_vector(std::from_range_t, R &&rg, const Allocator &alloc = Allocator())
+      : small_vector(alloc) {
+    if constexpr (stdr::sized_range<R>) {
+      reserve(stdr::size(rg));
+    }
+
+    for (auto &&e : rg) {
+      emplace_back(std::forward<decltype(e)>(e));
+    }
+  }
+
+  template <std::forward_iterator ForwardIt>
+  small_vector(ForwardIt first, ForwardIt last,
+               const Allocator &alloc = Allocator())
+      : small_vector(alloc) {
+    auto count = static_cast<size_type>(std::distance(first, last));
+    reserve(count);
+    std::uninitialized_copy(first, last, m_data);
+    m_size = count;
+  }
+
+  // copy ctor
+  small_vector(const small_vector &other)
+      : small_vector(other.cbegin(), other.cend(),
+                     alloc_traits::select_on_container_copy_construction(
+                         other.m_alloc)) {}
+
+  // move ctor
+  small_vector(small_vector &&other) noexcept(
+      is_trivially_relocatable_v<T> ||
+      std::is_nothrow_move_constructible_v<T>)
+      : small_vector(other.m_alloc) {
+    take(other);
+  }
+
+  // initializer list
+  small_vector(std::initializer_list<value_type> ilist,
+               const Allocator &alloc = Allocator())
+      : small_vector(ilist.begin(), ilist.end(), alloc) {}
+
+  // dtor
+  ~small_vector() {
+    std::destroy(begin(), end());
+    deallocate(m_data, m_capacity);
+  }
+
+  // member functions
+  small_vector &operator=(const small_vector &other) {
+    if (this != &other) {
+      clear();
+      insert(end(), other.begin(), other.end());
+    }
+    return *this;
+  }
+
+  small_vector &operator=(small_vector &&other) noexcept(
+      (alloc_traits::propagate_on_container_move_assignment::value ||
+       alloc_traits::is_always_equal::value) &&
+      (is_trivially_relocatable_v<T> ||
+       std::is_nothrow_move_constructible_v<T>)) {
+    if (this != &other) {
+      clear();
+      if constexpr (!alloc_traits::propagate_on_container_move_assignment::
+                        value &&
+                    !alloc_traits::is_always_equal::value) {
+        // a heap buffer of an unequal allocator can't be adopted, move the
+        // elements into storage of our own
+        if (m_alloc != other.m_alloc) {
+          reserve(other.size());
+          detail::relocate(other.begin(), other.end(), m_data);
+          m_size = other.m_size;
+          other.m_size = 0;
+          return *this;
+        }
+      }
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                        value) {
+        // our heap buffer goes back to the allocator that made it first
+        if (!is_inline()) {
+          deallocate(m_data, m_capacity);
+          m_data = inline_data();
+          m_capacity = N;
+        }
+        m_alloc = std::move(other.m_alloc);
+      }
+      take(other);
+    }
+    return *this;
+  }
+
+  small_vector &operator=(std::initializer_list<value_type> ilist) {
+    clear();
+    insert(end(), ilist.begin(), ilist.end());
+    return *this;
+  }
+
+  allocator_type get_allocator() const noexcept { return m_alloc; }
+
+  // element access
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::small_vector::at: index out of range");
+    }
+    return *(begin() + pos);
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::small_vector::at: index out of range");
+    }
+    return *(begin() + pos);
+  }
+  reference operator[](size_type pos) { return *(begin() + pos); }
+  const_reference operator[](size_type pos) const { return *(begin() + pos); }
+  reference front() { return *begin(); }
+  const_reference front() const { return *begin(); }
+  reference back() { return *(end() - 1); }
+  const_reference back() const { return *(end() - 1); }
+  pointer data() noexcept { return m_data; }
+  const_pointer data() const noexcept { return m_data; }
+
+  // iterators
+  iterator begin() noexcept { return m_data; }
+  const_iterator begin() const noexcept { return m_data; }
+  const_iterator cbegin() const noexcept { return m_data; }
+  iterator end() noexcept { return m_data + m_size; }
+  const_iterator end() const noexcept { return m_data + m_size; }
+  const_iterator cend() const noexcept { return m_data + m_size; }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return (size() == 0); }
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+  [[nodiscard]] size_type max_size() const noexcept {
+    return std::numeric_limits<difference_type>::max();
+  }
+  [[nodiscard]] size_type capacity() const noexcept { return m_capacity; }
+  [[nodiscard]] static constexpr size_type inline_capacity() noexcept {
+    return N;
+  }
+  // true while the elements live inside the object
+  [[nodiscard]] bool is_inline() const noexcept {
+    return m_data == inline_data();
+  }
+
+  void reserve(size_type new_cap) {
+    if (new_cap > max_size())
+      throw std::length_error("my::small_vector::reserve: can't reserve space "
+                              "greater than max_size()!");
+    if (capacity() >= new_cap)
+      return;
+    auto [new_data, got] = allocate(new_cap);
+    try {
+      detail::relocate(begin(), end(), new_data);
+    } catch (...) {
+      deallocate(new_data, got);
+      throw;
+    }
+    adopt(new_data, got);
+  }
+
+  void shrink_to_fit() {
+    if (is_inline() || capacity() == size())
+      return;
+
+    if (size() <= N) {
+      // fits inline again
+      auto old_data = m_data;
+      detail::relocate(begin(), end(), inline_data());
+      m_data = inline_data();
+      alloc_traits::deallocate(m_alloc, old_data, m_capacity);
+      m_capacity = N;
+      return;
+    }
+
+    auto [new_data, got] = allocate(size());
+    if (got >= capacity()) {
+      deallocate(new_data, got);
+      return;
+    }
+    try {
+      detail::relocate(begin(), end(), new_data);
+    } catch (...) {
+      deallocate(new_data, got);
+      throw;
+    }
+    adopt(new_data, got);
+  }
+
+  // modifiers
+  void clear() noexcept {
+    std::destroy(begin(), end());
+    m_size = 0;
+  }
+
+  // insert
+  iterator insert(const_iterator pos, const_reference value) {
+    return emplace(pos, value);
+  }
+
+  iterator insert(const_iterator pos, T &&value) {
+    return emplace(pos, std::move(value));
+  }
+
+  iterator insert(const_iterator pos, size_type count, const T &value) {
+    assert((pos >= cbegin()) && (pos <= cend()));
+
+    auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
+    if (count == 0) {
+      return begin() + idx;
+    }
+    auto old_size = size();
+
+    if (count + old_size > capacity()) {
+      // Case 1: re-allocate new spaces
+      auto [new_data, got] =
+          allocate(grow_capacity(capacity(), count + old_size));
+      try {
+        detail::insert_relocate(
+            begin(), begin() + idx, end(), new_data, count,
+            [&](pointer p) { std::uninitialized_fill_n(p, count, value); });
+      } catch (...) {
+        deallocate(new_data, got);
+        throw;
+      }
+      adopt(new_data, got);
+    } else {
+      detail::insert_fill_in_place(begin() + idx, end(), count, value);
+    }
+    m_size = old_size + count;
+    return begin() + idx;
+  }
+
+  template <std::forward_iterator ForwardIt>
+  iterator insert(const_iterator pos, ForwardIt first, ForwardIt last) {
+    // ub if either first or last are iterators into *this
+    assert((pos >= cbegin()) && (pos <= cend()));
+
+    auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
+    if (first == last) {
+      return begin() + idx;
+    }
+    auto old_size = size();
+    auto count = static_cast<size_type>(std::distance(first, last));
+
+    if (count + old_size > capacity()) {
+      // Case 1: re-allocate new spaces
+      auto [new_data, got] =
+          allocate(grow_capacity(capacity(), count + old_size));
+      try {
+        detail::insert_relocate(
+            begin(), begin() + idx, end(), new_data, count,
+            [&](pointer p) { std::uninitialized_copy(first, last, p); });
+      } catch (...) {
+        deallocate(new_data, got);
+        throw;
+      }
+      adopt(new_data, got);
+    } else {
+      detail::insert_copy_in_place(begin() + idx, end(), first, count);
+    }
+    m_size = old_size + count;
+    return begin() + idx;
+  }
+
+  iterator insert(const_iterator pos, std::initializer_list<T> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+  }
+
+  // emplace
+  template <class... Args>
+  iterator emplace(const_iterator pos, Args &&...args) {
+    assert((pos >= cbegin()) && (pos <= cend()));
+    auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
+    if (idx == size()) {
+      emplace_back(std::forward<Args>(args)...);
+      return begin() + idx;
+    }
+
+    // args may refer to elements that are about to move
+    T temp(std::forward<Args>(args)...);
+    if (capacity() == size()) {
+      reserve(grow_capacity(capacity(), size() + 1));
+    }
+
+    detail::emplace_in_place(begin() + idx, end(), std::move(temp));
+
+    ++m_size;
+    return begin() + idx;
+  }
+
+  // erase
+  iterator erase(const_iterator pos) {
+    assert((pos >= cbegin()) && (pos < cend()));
+    return erase(pos, pos + 1);
+  }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    assert(first <= last);
+    assert(first >= cbegin() && last <= cend());
+
+    auto idx = static_cast<size_type>(first - cbegin());
+    auto num_to_erase = static_cast<size_type>(last - first);
+    if (num_to_erase == 0)
+      return begin() + idx;
+
+    detail::erase_in_place(begin() + idx, begin() + idx + num_to_erase, end());
+    m_size -= num_to_erase;
+
+    return begin() + idx;
+  }
+
+  void push_back(const_reference value) { emplace_back(value); }
+
+  void push_back(value_type &&value) { emplace_back(std::move(value)); }
+
+  template <class... Args> reference emplace_back(Args &&...args) {
+    if (capacity() >= size() + 1) {
+      new (end()) T(std::forward<Args>(args)...);
+    } else {
+      // Reallocation needed - construct temporary first to handle
+      // self-references
+      T temp(std::forward<Args>(args)...);
+      reserve(grow_capacity(capacity(), size() + 1));
+      new (end()) T(std::move(temp));
+    }
+    ++m_size;
+    return back();
+  }
+
+  void pop_back() {
+    if (empty())
+      return;
+    std::destroy_at(end() - 1);
+    --m_size;
+  }
+
+  void resize(size_type count) { resize(count, T{}); }
+
+  void resize(size_type count, const T &value) {
+    if (count == size())
+      return;
+    if (count < size()) {
+      std::destroy(begin() + count, end());
+    } else {
+      reserve(count);
+      std::uninitialized_fill_n(end(), count - size(), value);
+    }
+    m_size = count;
+  }
+
+  void swap(small_vector &other) noexcept(
+      (alloc_traits::propagate_on_container_move_assignment::value ||
+       alloc_traits::is_always_equal::value) &&
+      (is_trivially_relocatable_v<T> ||
+       std::is_nothrow_move_constructible_v<T>)) {
+    if (this == &other)
+      return;
+    if (!is_inline() && !other.is_inline()) {
+      // both on the heap: trade buffers, no element moves
+      std::swap(m_data, other.m_data);
+      std::swap(m_size, other.m_size);
+      std::swap(m_capacity, other.m_capacity);
+      if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, other.m_alloc);
+      }
+      return;
+    }
+    small_vector temp(std::move(other));
+    other = std::move(*this);
+    *this = std::move(temp);
+  }
+};
+
+// Non-member functions
+template <class T, std::size_t N, class Alloc, class Growth>
+auto operator<=>(const small_vector<T, N, Alloc, Growth> &lhs,
+                 const small_vector<T, N, Alloc, Growth> &rhs) {
+  return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(),
+                                                rhs.begin(), rhs.end());
+}
+
+template <class T, std::size_t N, class Alloc, class Growth>
+bool operator==(const small_vector<T, N, Alloc, Growth> &lhs,
+                const small_vector<T, N, Alloc, Growth> &rhs) {
+  return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+} // namespace my
@@ -0,0 +1,429 @@
+#pragma once
+#include "vector.h"
+#include <algorithm>
+#include <array>
+#include <compare>
+#include <cstddef>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <new>
+#include <span>
+#include <stdexcept>
+#include <tuple>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Structure-of-arrays vector: every field lives in its own contiguous column
+// so a scan over one field streams only that field's bytes. All columns sit
+// in one allocation, each starting on a 64-byte boundary, and share a single
+// size and capacity. Element i is the tuple of the i-th entry of each column.
+//
+// Fields must be nothrow movable, so moving a row across columns can't fail
+// halfway and leave the columns with different lengths.
+template <class... Fields> class soa_vector {
+  static_assert(sizeof...(Fields) > 0, "my::soa_vector: needs a field");
+  static_assert((std::is_nothrow_move_constructible_v<Fields> && ...) &&
+                    (std::is_nothrow_move_assignable_v<Fields> && ...),
+                "my::soa_vector: fields must be nothrow movable");
+
+  static constexpr std::size_t field_count = sizeof...(Fields);
+
+public:
+  using value_type = std::tuple<Fields...>;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using reference = std::tuple<Fields &...>;
+  using const_reference = std::tuple<const Fields &...>;
+
+  template <std::size_t I>
+  using field_type = std::tuple_element_t<I, value_type>;
+
+  static constexpr std::size_t column_alignment = 64;
+
+  template <bool Const> class zip_iterator {
+    template <bool> friend class zip_iterator;
+    using container = std::conditional_t<Const, const soa_vector, soa_vector>;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::tuple<Fields...>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference =
+        std::conditional_t<Const, typename soa_vector::const_reference,
+                           typename soa_vector::reference>;
+
+    zip_iterator() noexcept = default;
+    zip_iterator(container *c, size_type idx) noexcept : m_c{c}, m_idx{idx} {}
+    template <bool C = Const>
+      requires C
+    zip_iterator(const zip_iterator<false> &other) noexcept
+        : m_c{other.m_c}, m_idx{other.m_idx} {}
+
+    reference operator*() const noexcept { return (*m_c)[m_idx]; }
+    reference operator[](difference_type n) const noexcept {
+      return *(*this + n);
+    }
+
+    zip_iterator &operator++() noexcept {
+      ++m_idx;
+      return *this;
+    }
+    zip_iterator operator++(int) noexcept {
+      auto tmp = *this;
+      ++m_idx;
+      return tmp;
+    }
+    zip_iterator &operator--() noexcept {
+      --m_idx;
+      return *this;
+    }
+    zip_iterator operator--(int) noexcept {
+      auto tmp = *this;
+      --m_idx;
+      return tmp;
+    }
+    zip_iterator &operator+=(difference_type n) noexcept {
+      m_idx = static_cast<size_type>(static_cast<difference_type>(m_idx) + n);
+      return *this;
+    }
+    zip_iterator &operator-=(difference_type n) noexcept {
+      return *this += -n;
+    }
+    friend zip_iterator operator+(zip_iterator it, difference_type n) noexcept {
+      return it += n;
+    }
+    friend zip_iterator operator+(difference_type n, zip_iterator it) noexcept {
+      return it += n;
+    }
+    friend zip_iterator operator-(zip_iterator it, difference_type n) noexcept {
+      return it -= n;
+    }
+    friend difference_type operator-(const zip_iterator &a,
+                                     const zip_iterator &b) noexcept {
+      return static_cast<difference_type>(a.m_idx) -
+             static_cast<difference_type>(b.m_idx);
+    }
+    friend bool operator==(const zip_iterator &a,
+                           const zip_iterator &b) noexcept {
+      return a.m_idx == b.m_idx;
+    }
+    friend auto operator<=>(const zip_iterator &a,
+                            const zip_iterator &b) noexcept {
+      return a.m_idx <=> b.m_idx;
+    }
+
+    // position in the columns, for indexing them directly
+    size_type index() const noexcept { return m_idx; }
+
+  private:
+    container *m_c = nullptr;
+    size_type m_idx = 0;
+  };
+
+  using iterator = zip_iterator<false>;
+  using const_iterator = zip_iterator<true>;
+
+private:
+  using index_sequence = std::index_sequence_for<Fields...>;
+
+  static constexpr size_type round_up(size_type bytes) noexcept {
+    return (bytes + column_alignment - 1) / column_alignment *
+           column_alignment;
+  }
+
+  // byte offset of every column in a block holding cap rows, then the total
+  static constexpr std::array<size_type, field_count + 1>
+  layout(size_type cap) noexcept {
+    constexpr std::array<size_type, field_count> sizes{sizeof(Fields)...};
+    std::array<size_type, field_count + 1> offsets{};
+    for (size_type i = 0; i < field_count; ++i) {
+      offsets[i + 1] = offsets[i] + round_up(cap * sizes[i]);
+    }
+    return offsets;
+  }
+
+  static constexpr size_type grow_capacity(size_type cap, size_type required) {
+    return default_growth::next_capacity(cap, required, (sizeof(Fields) + ...));
+  }
+
+  template <std::size_t I> field_type<I> *col() const noexcept {
+    return std::get<I>(m_columns);
+  }
+
+  template <class F> void for_each_column(F &&f) const {
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (f(col<I>()), ...);
+    }(index_sequence{});
+  }
+
+  // moves all rows into a fresh block with room for new_cap rows
+  void reallocate(size_type new_cap) {
+    auto offsets = layout(new_cap);
+    auto *block = static_cast<std::byte *>(::operator new(
+        offsets[field_count], std::align_val_t{column_alignment}));
+    auto columns = [&]<std::size_t... I>(std::index_sequence<I...>) {
+      return std::tuple<Fields *...>{
+          reinterpret_cast<Fields *>(block + offsets[I])...};
+    }(index_sequence{});
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (detail::relocate(col<I>(), col<I>() + m_size, std::get<I>(columns)),
+       ...);
+    }(index_sequence{});
+    release();
+    m_block = block;
+    m_columns = columns;
+    m_capacity = new_cap;
+  }
+
+  void release() noexcept {
+    if (m_block != nullptr) {
+      ::operator delete(m_block, std::align_val_t{column_alignment});
+    }
+  }
+
+  void grow_for(size_type extra) {
+    if (m_size + extra > m_capacity) {
+      if (m_size + extra > max_size())
+        throw std::length_error("my::soa_vector: size exceeds max_size()");
+      reallocate(grow_capacity(m_capacity, m_size + extra));
+    }
+  }
+
+  std::byte *m_block = nullptr;
+  std::tuple<Fields *...> m_columns{};
+  size_type m_size = 0;
+  size_type m_capacity = 0;
+
+public:
+  // ctor
+  soa_vector() noexcept = default;
+
+  explicit soa_vector(size_type count) : soa_vector() {
+    reserve(count);
+    for (size_type i = 0; i < count; ++i) {
+      emplace_back();
+    }
+  }
+
+  soa_vector(std::initializer_list<value_type> ilist) : soa_vector() {
+    reserve(ilist.size());
+    for (const auto &row : ilist) {
+      push_back(row);
+    }
+  }
+
+  soa_vector(const soa_vector &other) : soa_vector() {
+    reserve(other.m_size);
+    for (const auto &row : other) {
+      std::apply([&](const auto &...f) { emplace_back(f...); }, row);
+    }
+  }
+
+  soa_vector(soa_vector &&other) noexcept
+      : m_block{std::exchange(other.m_block, nullptr)},
+        m_columns{std::exchange(other.m_columns, {})},
+        m_size{std::exchange(other.m_size, 0)},
+        m_capacity{std::exchange(other.m_capacity, 0)} {}
+
+  // dtor
+  ~soa_vector() {
+    clear();
+    release();
+  }
+
+  soa_vector &operator=(const soa_vector &other) {
+    if (this != &other) {
+      soa_vector temp(other);
+      swap(temp);
+    }
+    return *this;
+  }
+
+  soa_vector &operator=(soa_vector &&other) noexcept {
+    if (this != &other) {
+      soa_vector temp(std::move(other));
+      swap(temp);
+    }
+    return *this;
+  }
+
+  // element access
+  reference operator[](size_type pos) noexcept {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+      return reference{col<I>()[pos]...};
+    }(index_sequence{});
+  }
+  const_reference operator[](size_type pos) const noexcept {
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+      return const_reference{col<I>()[pos]...};
+    }(index_sequence{});
+  }
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::soa_vector::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::soa_vector::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  reference front() noexcept { return (*this)[0]; }
+  const_reference front() const noexcept { return (*this)[0]; }
+  reference back() noexcept { return (*this)[m_size - 1]; }
+  const_reference back() const noexcept { return (*this)[m_size - 1]; }
+
+  // one field of every row, contiguous and 64-byte aligned
+  template <std::size_t I> std::span<field_type<I>> column() noexcept {
+    return {col<I>(), m_size};
+  }
+  template <std::size_t I>
+  std::span<const field_type<I>> column() const noexcept {
+    return {col<I>(), m_size};
+  }
+
+  // iterators
+  iterator begin() noexcept { return iterator(this, 0); }
+  const_iterator begin() const noexcept { return const_iterator(this, 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept { return iterator(this, m_size); }
+  const_iterator end() const noexcept { return const_iterator(this, m_size); }
+  const_iterator cend() const noexcept { return end(); }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+  [[nodiscard]] size_type max_size() const noexcept {
+    return std::numeric_limits<difference_type>::max() /
+           (sizeof(Fields) + ...);
+  }
+  [[nodiscard]] size_type capacity() const noexcept { return m_capacity; }
+  void reserve(size_type new_cap) {
+    if (new_cap > max_size())
+      throw std::length_error(
+          "my::soa_vector::reserve: can't reserve space greater than "
+          "max_size()!");
+    if (new_cap > m_capacity)
+      reallocate(new_cap);
+  }
+  void shrink_to_fit() {
+    if (m_size == m_capacity)
+      return;
+    if (m_size == 0) {
+      release();
+      m_block = nullptr;
+      m_columns = {};
+      m_capacity = 0;
+      return;
+    }
+    reallocate(m_size);
+  }
+
+  // modifiers
+  void clear() noexcept {
+    for_each_column([&](auto *c) { std::destroy(c, c + m_size); });
+    m_size = 0;
+  }
+
+  // one constructor argument per field, or none to value-initialize the row
+  template <class... Args>
+    requires(sizeof...(Args) == 0 || sizeof...(Args) == field_count)
+  reference emplace_back(Args &&...args) {
+    // build the row before touching the columns: it may alias one of them
+    value_type row(std::forward<Args>(args)...);
+    grow_for(1);
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (::new (static_cast<void *>(col<I>() + m_size))
+           Fields(std::move(std::get<I>(row))),
+       ...);
+    }(index_sequence{});
+    ++m_size;
+    return back();
+  }
+
+  void push_back(const value_type &row) {
+    std::apply([&](const auto &...f) { emplace_back(f...); }, row);
+  }
+  void push_back(value_type &&row) {
+    std::apply([&](auto &...f) { emplace_back(std::move(f)...); }, row);
+  }
+
+  void pop_back() noexcept {
+    --m_size;
+    for_each_column([&](auto *c) { std::destroy_at(c + m_size); });
+  }
+
+  void resize(size_type count) {
+    if (count < m_size) {
+      for_each_column([&](auto *c) { std::destroy(c + count, c + m_size); });
+      m_size = count;
+      return;
+    }
+    reserve(count);
+    while (m_size < count) {
+      emplace_back();
+    }
+  }
+
+  template <class... Args>
+    requires(sizeof...(Args) == 0 || sizeof...(Args) == field_count)
+  iterator emplace(const_iterator pos, Args &&...args) {
+    auto idx = pos.index();
+    value_type row(std::forward<Args>(args)...);
+    grow_for(1);
+    [&]<std::size_t... I>(std::index_sequence<I...>) {
+      (detail::emplace_in_place(col<I>() + idx, col<I>() + m_size,
+                                std::move(std::get<I>(row))),
+       ...);
+    }(index_sequence{});
+    ++m_size;
+    return begin() + static_cast<difference_type>(idx);
+  }
+
+  iterator insert(const_iterator pos, const value_type &row) {
+    return std::apply(
+        [&](const auto &...f) { return emplace(pos, f...); }, row);
+  }
+  iterator insert(const_iterator pos, value_type &&row) {
+    return std::apply(
+        [&](auto &...f) { return emplace(pos, std::move(f)...); }, row);
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto b = first.index();
+    auto e = last.index();
+    if (b != e) {
+      for_each_column([&](auto *c) {
+        detail::erase_in_place(c + b, c + e, c + m_size);
+      });
+      m_size -= e - b;
+    }
+    return begin() + static_cast<difference_type>(b);
+  }
+
+  void swap(soa_vector &other) noexcept {
+    std::swap(m_block, other.m_block);
+    std::swap(m_columns, other.m_columns);
+    std::swap(m_size, other.m_size);
+    std::swap(m_capacity, other.m_capacity);
+  }
+
+  friend bool operator==(const soa_vector &lhs, const soa_vector &rhs) {
+    if (lhs.m_size != rhs.m_size)
+      return false;
+    return [&]<std::size_t... I>(std::index_sequence<I...>) {
+      return (std::ranges::equal(lhs.template column<I>(),
+                                 rhs.template column<I>()) &&
+              ...);
+    }(index_sequence{});
+  }
+};
+} // namespace my
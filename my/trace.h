@@ -0,0 +1,222 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if defined(MY_STL_ENABLE_TRACING)
+#include <atomic>
+#include <chrono>
+#include <new>
+#endif
+
+// Opt-in container event tracing.
+//
+// Build with MY_STL_ENABLE_TRACING defined (the CMake option of the same name
+// sets it for every target linking lib_my_stl; it must be the same in every
+// translation unit) and the containers record growth, shrink_to_fit, list
+// node allocation and large inserts into a per-thread ring buffer. Without it
+// MY_STL_TRACE expands to nothing and its arguments are never evaluated.
+//
+// Events carry the caller tag of the innermost trace::scope on the recording
+// thread, so a realloc storm can be pinned to a call site:
+//
+//   my::trace::scope tag("parse_rows");
+//   rows.push_back(...);
+//
+// trace_dump.h reads the rings back.
+
+namespace my::trace {
+
+enum class event_kind : std::uint8_t {
+  growth,       // a: old capacity, b: new capacity, c: bytes relocated
+  shrink,       // a: old capacity, b: new capacity, c: bytes relocated
+  node_alloc,   // a: node bytes
+  node_free,    // a: node bytes
+  large_insert, // a: element count, b: bytes, c: position
+};
+
+constexpr const char *to_string(event_kind kind) noexcept {
+  switch (kind) {
+  case event_kind::growth:
+    return "growth";
+  case event_kind::shrink:
+    return "shrink";
+  case event_kind::node_alloc:
+    return "node_alloc";
+  case event_kind::node_free:
+    return "node_free";
+  case event_kind::large_insert:
+    return "large_insert";
+  }
+  return "unknown";
+}
+
+struct event {
+  std::uint64_t timestamp_ns; // steady_clock
+  const char *tag;            // nullptr outside any scope
+  const void *object;         // the container
+  std::uint32_t thread;       // ring number, in order of first event
+  event_kind kind;
+  std::uint64_t a;
+  std::uint64_t b;
+  std::uint64_t c;
+};
+
+// inserts of at least this many bytes are recorded as large_insert
+inline constexpr std::size_t large_insert_bytes = std::size_t{64} << 10;
+
+#if defined(MY_STL_ENABLE_TRACING)
+inline constexpr bool enabled = true;
+
+#ifndef MY_STL_TRACE_RING_SIZE
+#define MY_STL_TRACE_RING_SIZE 4096
+#endif
+
+namespace detail {
+inline const char *&current_tag() noexcept {
+  thread_local const char *tag = nullptr;
+  return tag;
+}
+
+// Single producer ring of the last ring_size events of one thread. Slots are
+// atomics so that a reader on another thread can copy them while they are
+// being overwritten; `claimed` runs ahead of `published` like a seqlock and
+// tells the reader which of the copies it made may be torn.
+struct ring {
+  static constexpr std::size_t ring_size = MY_STL_TRACE_RING_SIZE;
+  static_assert((ring_size & (ring_size - 1)) == 0,
+                "MY_STL_TRACE_RING_SIZE must be a power of two");
+
+  struct slot {
+    std::atomic<std::uint64_t> timestamp_ns;
+    std::atomic<const char *> tag;
+    std::atomic<const void *> object;
+    std::atomic<event_kind> kind;
+    std::atomic<std::uint64_t> a;
+    std::atomic<std::uint64_t> b;
+    std::atomic<std::uint64_t> c;
+  };
+
+  explicit ring(std::uint32_t id) noexcept : thread{id} {}
+
+  void push(const event &e) noexcept {
+    auto n = claimed.load(std::memory_order_relaxed);
+    claimed.store(n + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    auto &s = slots[n & (ring_size - 1)];
+    s.timestamp_ns.store(e.timestamp_ns, std::memory_order_relaxed);
+    s.tag.store(e.tag, std::memory_order_relaxed);
+    s.object.store(e.object, std::memory_order_relaxed);
+    s.kind.store(e.kind, std::memory_order_relaxed);
+    s.a.store(e.a, std::memory_order_relaxed);
+    s.b.store(e.b, std::memory_order_relaxed);
+    s.c.store(e.c, std::memory_order_relaxed);
+    published.store(n + 1, std::memory_order_release);
+  }
+
+  // calls f(event) for the events still held, oldest first
+  template <class F> void read(F f) const {
+    auto last = published.load(std::memory_order_acquire);
+    auto first = last > ring_size ? last - ring_size : 0;
+    event copies[64];
+    for (auto n = first; n < last;) {
+      std::size_t count = 0;
+      auto batch = n;
+      for (; n < last && count < std::size(copies); ++n, ++count) {
+        const auto &s = slots[n & (ring_size - 1)];
+        copies[count] = {s.timestamp_ns.load(std::memory_order_relaxed),
+                         s.tag.load(std::memory_order_relaxed),
+                         s.object.load(std::memory_order_relaxed),
+                         thread,
+                         s.kind.load(std::memory_order_relaxed),
+                         s.a.load(std::memory_order_relaxed),
+                         s.b.load(std::memory_order_relaxed),
+                         s.c.load(std::memory_order_relaxed)};
+      }
+      std::atomic_thread_fence(std::memory_order_acquire);
+      // copies of events the writer has lapped since may be torn
+      auto lapped = claimed.load(std::memory_order_relaxed);
+      for (std::size_t i = 0; i < count; ++i) {
+        if (batch + i + ring_size >= lapped) {
+          f(copies[i]);
+        }
+      }
+    }
+  }
+
+  std::atomic<std::uint64_t> claimed{0};
+  std::atomic<std::uint64_t> published{0};
+  const std::uint32_t thread;
+  ring *next = nullptr;
+  slot slots[ring_size];
+};
+
+// every ring ever created, newest first; rings outlive their threads so that
+// their events can still be dumped
+inline std::atomic<ring *> rings{nullptr};
+inline std::atomic<std::uint32_t> ring_count{0};
+
+inline ring *this_thread_ring() noexcept {
+  thread_local ring *r = [] {
+    auto *p = new (std::nothrow)
+        ring(ring_count.fetch_add(1, std::memory_order_relaxed));
+    if (p != nullptr) {
+      p->next = rings.load(std::memory_order_relaxed);
+      while (!rings.compare_exchange_weak(p->next, p,
+                                          std::memory_order_release,
+                                          std::memory_order_relaxed)) {
+      }
+    }
+    return p;
+  }();
+  return r;
+}
+
+inline void record(event_kind kind, const void *object, std::uint64_t a,
+                   std::uint64_t b = 0, std::uint64_t c = 0) noexcept {
+  auto *r = this_thread_ring();
+  if (r == nullptr) {
+    return; // out of memory: drop the event
+  }
+  auto now = std::chrono::steady_clock::now().time_since_epoch();
+  r->push({static_cast<std::uint64_t>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(now)
+                   .count()),
+           current_tag(), object, r->thread, kind, a, b, c});
+}
+} // namespace detail
+
+// tags the events this thread records until the scope ends; tag must
+// outlive the trace, a string literal is the usual choice
+class scope {
+public:
+  explicit scope(const char *tag) noexcept
+      : m_prev{std::exchange(detail::current_tag(), tag)} {}
+  scope(const scope &) = delete;
+  scope &operator=(const scope &) = delete;
+  ~scope() { detail::current_tag() = m_prev; }
+
+private:
+  const char *m_prev;
+};
+
+#define MY_STL_TRACE(kind, ...)                                                \
+  do {                                                                         \
+    if !consteval {                                                            \
+      ::my::trace::detail::record(::my::trace::event_kind::kind, __VA_ARGS__); \
+    }                                                                          \
+  } while (false)
+
+#else
+inline constexpr bool enabled = false;
+
+class scope {
+public:
+  explicit scope(const char *) noexcept {}
+  scope(const scope &) = delete;
+  scope &operator=(const scope &) = delete;
+};
+
+#define MY_STL_TRACE(kind, ...) ((void)0)
+#endif
+} // namespace my::trace
@@ -0,0 +1,84 @@
+#pragma once
+#include "trace.h"
+#include "vector.h"
+#include <algorithm>
+#include <cstdint>
+#include <map>
+#include <ostream>
+#include <string_view>
+#include <tuple>
+
+// Reading back the events recorded with MY_STL_ENABLE_TRACING. Safe to call
+// while other threads keep recording; events they overwrite meanwhile are
+// left out. Without tracing every function here sees no events.
+
+namespace my::trace {
+
+// the events every ring still holds, oldest first
+inline vector<event> snapshot() {
+  vector<event> events;
+#if defined(MY_STL_ENABLE_TRACING)
+  for (auto *r = detail::rings.load(std::memory_order_acquire); r != nullptr;
+       r = r->next) {
+    r->read([&](const event &e) { events.push_back(e); });
+  }
+  std::stable_sort(events.begin(), events.end(),
+                   [](const event &x, const event &y) {
+                     return x.timestamp_ns < y.timestamp_ns;
+                   });
+#endif
+  return events;
+}
+
+// one line per event:
+// <ns> <thread> <kind> <tag> <object> <a> <b> <c>
+inline void dump(std::ostream &os, const vector<event> &events) {
+  for (const auto &e : events) {
+    os << e.timestamp_ns << ' ' << e.thread << ' ' << to_string(e.kind) << ' '
+       << (e.tag ? e.tag : "-") << ' ' << e.object << ' ' << e.a << ' '
+       << e.b << ' ' << e.c << '\n';
+  }
+}
+
+inline void dump(std::ostream &os) { dump(os, snapshot()); }
+
+// Event count and bytes per tag and kind, busiest first: the tags at the top
+// of the growth rows are where reserve() calls are missing.
+inline void summarize(std::ostream &os, const vector<event> &events) {
+  struct totals {
+    std::uint64_t count = 0;
+    std::uint64_t bytes = 0;
+  };
+  std::map<std::tuple<std::string_view, event_kind>, totals> by_tag;
+  for (const auto &e : events) {
+    auto &t = by_tag[{e.tag ? e.tag : "-", e.kind}];
+    ++t.count;
+    switch (e.kind) {
+    case event_kind::growth:
+    case event_kind::shrink:
+      t.bytes += e.c;
+      break;
+    case event_kind::node_alloc:
+    case event_kind::node_free:
+      t.bytes += e.a;
+      break;
+    case event_kind::large_insert:
+      t.bytes += e.b;
+      break;
+    }
+  }
+
+  vector<std::pair<std::tuple<std::string_view, event_kind>, totals>> rows(
+      by_tag.begin(), by_tag.end());
+  std::stable_sort(rows.begin(), rows.end(), [](const auto &x, const auto &y) {
+    return x.second.count > y.second.count;
+  });
+  os << "tag kind count bytes\n";
+  for (const auto &[key, t] : rows) {
+    os << std::get<0>(key) << ' ' << to_string(std::get<1>(key)) << ' '
+       << t.count << ' ' << t.bytes << '\n';
+  }
+}
+
+inline void summarize(std::ostream &os) { summarize(os, snapshot()); }
+} // namespace my::trace
@@ -1,5 +1,7 @@
 #pragma once
 #include <cstddef>
+#include <memory>
+#include <string>
 #include <type_traits>
 using std::size_t;
 
@@ -25,7 +27,7 @@ template <class T> struct is_floating_point;
 template <class T> struct is_array;
 
 template <class T> struct is_pointer : false_type {};
-template <class T *> struct is_pointer : true_type {};
+template <class T> struct is_pointer<T *> : true_type {};
 template <class T> struct is_pointer<T *const> : true_type {};
 template <class T> struct is_pointer<T *volatile> : true_type {};
 template <class T> struct is_pointer<T *const volatile> : true_type {};
@@ -462,4 +464,31 @@ constexpr bool is_corresponding_member(M1 S1::*m1, M2 S2::*m2) noexcept;
 // constant evaluation context
 constexpr bool is_constant_evaluated() noexcept;
 consteval bool is_within_lifetime(const auto *) noexcept;
+
+// relocation: moving an object to new storage and destroying the source can
+// be done with a plain memcpy. Every trivially copyable type qualifies, other
+// types opt in by specializing is_trivially_relocatable.
+template <class T>
+struct is_trivially_relocatable
+    : bool_constant<std::is_trivially_copyable_v<T> &&
+                    !std::is_volatile_v<T>> {};
+
+template <class T>
+inline constexpr bool is_trivially_relocatable_v =
+    is_trivially_relocatable<T>::value;
+
+template <class T>
+struct is_trivially_relocatable<std::unique_ptr<T, std::default_delete<T>>>
+    : true_type {};
+
+template <class T>
+struct is_trivially_relocatable<std::shared_ptr<T>> : true_type {};
+
+#if defined(_LIBCPP_VERSION)
+// libstdc++'s std::string points into itself while in SSO mode, so only the
+// libc++ layout can be relocated bytewise
+template <class CharT, class Traits>
+struct is_trivially_relocatable<
+    std::basic_string<CharT, Traits, std::allocator<CharT>>> : true_type {};
+#endif
 } // namespace my
@@ -1,8 +1,16 @@
 #pragma once
+#include "allocator.h"
+#include "execution.h"
+#include "simd.h"
+#include "trace.h"
+#include "type_traits.h"
 #include <algorithm>
+#include <array>
 #include <cassert>
 #include <concepts>
 #include <cstddef>
+#include <cstring>
+#include <functional>
 #include <initializer_list>
 #include <iostream>
 #include <iterator>
@@ -21,9 +29,284 @@ template <class R, class T>
 concept container_compatible_range =
     stdr::input_range<R> && std::convertible_to<stdr::range_reference_t<R>, T>;
 
-template <class T> class vector {
+// Growth policies decide how much a full container grows:
+// G::next_capacity(cap, required, elem_size) returns the new capacity when at
+// least required elements must fit into storage currently holding cap.
+template <class G>
+concept growth_policy = requires(std::size_t n) {
+  { G::next_capacity(n, n, n) } -> std::convertible_to<std::size_t>;
+};
+
+// grows by a factor of Num / Den
+template <std::size_t Num, std::size_t Den = 1> struct geometric_growth {
+  static_assert(Num > Den, "my::geometric_growth: factor must exceed 1");
+
+  static constexpr std::size_t next_capacity(std::size_t cap,
+                                             std::size_t required,
+                                             std::size_t /* elem_size */) {
+    return std::max(required, cap / Den * Num + cap % Den * Num / Den);
+  }
+};
+
+using double_growth = geometric_growth<2>;
+using one_and_half_growth = geometric_growth<3, 2>;
+
+// doubles, then rounds the byte size up to whole pages so that no partial
+// page is ever left unused at the end of the buffer
+template <std::size_t PageSize = 4096> struct page_growth {
+  static constexpr std::size_t next_capacity(std::size_t cap,
+                                             std::size_t required,
+                                             std::size_t elem_size) {
+    auto bytes = double_growth::next_capacity(cap, required, elem_size) *
+                 elem_size;
+    bytes = (bytes + PageSize - 1) / PageSize * PageSize;
+    return bytes / elem_size;
+  }
+};
+
+// grows by a fixed number of elements at a time
+template <std::size_t Chunk> struct chunk_growth {
+  static_assert(Chunk > 0, "my::chunk_growth: chunk must be non-zero");
+
+  static constexpr std::size_t next_capacity(std::size_t /* cap */,
+                                             std::size_t required,
+                                             std::size_t /* elem_size */) {
+    return (required + Chunk - 1) / Chunk * Chunk;
+  }
+};
+
+using default_growth = double_growth;
+
+namespace detail {
+// The std uninitialized algorithms only become constexpr in C++26. These
+// forward to them at run time and construct element by element with
+// std::construct_at during constant evaluation, where nothing can throw and
+// no rollback is needed.
+template <std::input_iterator InputIt, class T>
+constexpr T *uninitialized_copy(InputIt first, InputIt last, T *d_first) {
+  if consteval {
+    for (; first != last; ++first, ++d_first) {
+      std::construct_at(d_first, *first);
+    }
+    return d_first;
+  } else {
+    return std::uninitialized_copy(first, last, d_first);
+  }
+}
+
+template <std::input_iterator InputIt, class T>
+constexpr T *uninitialized_copy_n(InputIt first, std::size_t count,
+                                  T *d_first) {
+  if consteval {
+    for (; count > 0; --count, ++first, ++d_first) {
+      std::construct_at(d_first, *first);
+    }
+    return d_first;
+  } else {
+    return std::uninitialized_copy_n(first, count, d_first);
+  }
+}
+
+template <class T>
+constexpr T *uninitialized_move(T *first, T *last, T *d_first) {
+  if consteval {
+    for (; first != last; ++first, ++d_first) {
+      std::construct_at(d_first, std::move(*first));
+    }
+    return d_first;
+  } else {
+    return std::uninitialized_move(first, last, d_first);
+  }
+}
+
+template <class T>
+constexpr T *uninitialized_fill_n(T *first, std::size_t count,
+                                  const T &value) {
+  if consteval {
+    for (; count > 0; --count, ++first) {
+      std::construct_at(first, value);
+    }
+    return first;
+  } else {
+    return std::uninitialized_fill_n(first, count, value);
+  }
+}
+
+template <class T>
+constexpr T *uninitialized_value_construct_n(T *first, std::size_t count) {
+  if consteval {
+    for (; count > 0; --count, ++first) {
+      std::construct_at(first);
+    }
+    return first;
+  } else {
+    return std::uninitialized_value_construct_n(first, count);
+  }
+}
+
+// constant evaluation can't read indeterminate values, so it value-initializes
+template <class T>
+constexpr T *uninitialized_default_construct_n(T *first, std::size_t count) {
+  if consteval {
+    return detail::uninitialized_value_construct_n(first, count);
+  } else {
+    return std::uninitialized_default_construct_n(first, count);
+  }
+}
+
+// moves [first, last) into the uninitialized storage at d_first and ends the
+// lifetime of the sources. Trivially relocatable types get a single memmove
+// at run time, so the two ranges may overlap; otherwise, and always during
+// constant evaluation, the ranges must be disjoint.
+template <class T> constexpr T *relocate(T *first, T *last, T *d_first) {
+  if constexpr (is_trivially_relocatable_v<T>) {
+    if !consteval {
+      auto count = static_cast<std::size_t>(last - first);
+      if (count != 0) {
+        std::memmove(static_cast<void *>(d_first),
+                     static_cast<const void *>(first), count * sizeof(T));
+      }
+      return d_first + count;
+    }
+  }
+  auto d_last = detail::uninitialized_move(first, last, d_first);
+  std::destroy(first, last);
+  return d_last;
+}
+
+// whether the in-place algorithms below shift elements with relocate; during
+// constant evaluation there is no memmove and they move element by element
+template <class T> constexpr bool shift_by_relocation() noexcept {
+  if consteval {
+    return false;
+  } else {
+    return is_trivially_relocatable_v<T>;
+  }
+}
+
+// Inserting count elements at pos into [first, last) falls into one of three
+// cases:
+//   Case 1: the storage is too small, so the whole result is built in fresh
+//           storage by insert_relocate.
+//   Case 2: number of inserted elements are "small": the tail is shifted
+//           and the gap consists of moved-from elements to assign over.
+//   Case 3: number of inserted elements are "large": part of the gap lies
+//           past the old end and is constructed rather than assigned.
+// Trivially relocatable types skip cases 2 and 3 and open the gap with one
+// memmove instead.
+
+// Case 1: construct(p) builds the count inserted elements at p. They are
+// built before anything is relocated, so the source may live in [first, last)
+template <class T, class Construct>
+constexpr void insert_relocate(T *first, T *pos, T *last, T *new_first,
+                               std::size_t count, Construct construct) {
+  auto idx = pos - first;
+  construct(new_first + idx);
+  relocate(first, pos, new_first);
+  relocate(pos, last, new_first + idx + count);
+}
+
+// Cases 2 and 3 for count copies of value, with room for count more elements
+// past last
+template <class T>
+constexpr void insert_fill_in_place(T *pos, T *last, std::size_t count,
+                                    const T &value) {
+  T value_copy = value; // value may be one of the elements about to move
+  auto tail = static_cast<std::size_t>(last - pos);
+  if (shift_by_relocation<T>()) {
+    relocate(pos, last, pos + count);
+    try {
+      detail::uninitialized_fill_n(pos, count, value_copy);
+    } catch (...) {
+      relocate(pos + count, last + count, pos);
+      throw;
+    }
+  } else if (count <= tail) {
+    // Case 2
+    detail::uninitialized_move(last - count, last, last);
+    std::move_backward(pos, last - count, last);
+    std::fill_n(pos, count, value_copy);
+  } else {
+    // Case 3
+    detail::uninitialized_move(pos, last, pos + count);
+    std::fill_n(pos, tail, value_copy);
+    detail::uninitialized_fill_n(last, count - tail, value_copy);
+  }
+}
+
+// Cases 2 and 3 for the count elements starting at src, each read once
+template <class T, std::input_iterator InputIt>
+constexpr void insert_copy_in_place(T *pos, T *last, InputIt src,
+                                    std::size_t count) {
+  auto tail = static_cast<std::size_t>(last - pos);
+  if (shift_by_relocation<T>()) {
+    relocate(pos, last, pos + count);
+    try {
+      detail::uninitialized_copy_n(src, count, pos);
+    } catch (...) {
+      relocate(pos + count, last + count, pos);
+      throw;
+    }
+  } else if (count <= tail) {
+    // Case 2
+    detail::uninitialized_move(last - count, last, last);
+    std::move_backward(pos, last - count, last);
+    std::copy_n(src, count, pos);
+  } else {
+    // Case 3
+    detail::uninitialized_move(pos, last, pos + count);
+    auto rest =
+        std::ranges::copy_n(src, static_cast<std::ptrdiff_t>(tail), pos).in;
+    detail::uninitialized_copy_n(rest, count - tail, last);
+  }
+}
+
+// single element version of the above; value must not alias [pos, last)
+template <class T>
+constexpr void emplace_in_place(T *pos, T *last, T &&value) {
+  if (shift_by_relocation<T>()) {
+    relocate(pos, last, pos + 1);
+    try {
+      std::construct_at(pos, std::move(value));
+    } catch (...) {
+      relocate(pos + 1, last + 1, pos);
+      throw;
+    }
+  } else if (pos == last) {
+    std::construct_at(last, std::move(value));
+  } else {
+    std::construct_at(last, std::move(*(last - 1)));
+    std::move_backward(pos, last - 1, last);
+    *pos = std::move(value);
+  }
+}
+
+// removes [first, last) from a sequence ending at end, returns the new end
+template <class T> constexpr T *erase_in_place(T *first, T *last, T *end) {
+  if (shift_by_relocation<T>()) {
+    std::destroy(first, last);
+    return relocate(last, end, first);
+  } else {
+    auto new_end = std::move(last, end, first);
+    std::destroy(new_end, end);
+    return new_end;
+  }
+}
+} // namespace detail
+
+// tag for constructors that default-initialize their elements: trivial types
+// are left with whatever the memory held instead of being zeroed
+struct default_init_t {
+  explicit default_init_t() = default;
+};
+inline constexpr default_init_t default_init{};
+
+template <class T, class Allocator = allocator<T>,
+          growth_policy Growth = default_growth>
+class vector {
 public:
   using value_type = T;
+  using allocator_type = Allocator;
   using size_type = std::size_t;
   using difference_type = std::ptrdiff_t;
   using pointer = T *;
@@ -36,17 +319,113 @@ public:
   using const_reverse_iterator = std::reverse_iterator<const_iterator>;
 
 private:
-  static inline constexpr float REALLOCATION_FACTOR = 2;
+  using alloc_traits = std::allocator_traits<allocator_type>;
+
+  // allocators that can resize a block in place (realloc, mremap) let
+  // relocatable elements grow without being copied
+  static constexpr bool can_reallocate =
+      is_trivially_relocatable_v<T> &&
+      requires(allocator_type &a, pointer p, size_type n) {
+        { a.reallocate(p, n, n) } -> std::same_as<allocation_result<pointer>>;
+      };
+
+  static constexpr size_type grow_capacity(size_type cap, size_type required) {
+    return Growth::next_capacity(cap, required, sizeof(T));
+  }
 
-  pointer allocate(size_type n) {
-    return static_cast<pointer>(operator new(n * sizeof(value_type)));
+  // where to read the elements of rg from: contiguous ranges of T decay to a
+  // plain pointer so the uninitialized algorithms can copy them in bulk
+  template <class R> static constexpr auto range_source(R &rg) {
+    if constexpr (stdr::contiguous_range<R> &&
+                  std::same_as<stdr::range_value_t<R>, T>) {
+      return stdr::data(rg);
+    } else {
+      return stdr::begin(rg);
+    }
   }
 
-  void deallocate(pointer p) { operator delete(p); }
+  // fills a freshly constructed, empty vector with count elements
+  template <class Construct>
+  void parallel_construct(size_type count, Construct construct) {
+    auto [ptr, cap] = allocate(count);
+    try {
+      detail::parallel_uninitialized(ptr, count, construct);
+    } catch (...) {
+      deallocate(ptr, cap);
+      throw;
+    }
+    m_data = ptr;
+    m_size = count;
+    m_capacity = cap;
+  }
+
+  // inserts the count elements starting at src, reading each of them once
+  template <std::input_iterator It>
+  constexpr iterator insert_n(const_iterator pos, It src, size_type count) {
+    auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
+    if (count == 0) {
+      return begin() + idx;
+    }
+    auto old_size = size();
+    trace_insert(count, idx);
+
+    if (count + old_size > capacity() && can_reallocate) {
+      reserve(grow_capacity(capacity(), count + old_size));
+      detail::insert_copy_in_place(begin() + idx, end(), src, count);
+    } else if (count + old_size > capacity()) {
+      // Case 1: re-allocate new spaces
+      auto [new_data, got] =
+          allocate(grow_capacity(capacity(), count + old_size));
+      try {
+        detail::insert_relocate(
+            begin(), begin() + idx, end(), new_data, count,
+            [&](pointer p) {
+              detail::uninitialized_copy_n(src, count, p);
+            });
+      } catch (...) {
+        deallocate(new_data, got);
+        throw;
+      }
+
+      MY_STL_TRACE(growth, this, m_capacity, got, old_size * sizeof(T));
+      deallocate(m_data, m_capacity);
+
+      m_data = new_data;
+      m_capacity = got;
+    } else {
+      detail::insert_copy_in_place(begin() + idx, end(), src, count);
+    }
+    m_size = old_size + count;
+    return begin() + idx;
+  }
+
+  // records inserts of at least trace::large_insert_bytes
+  constexpr void trace_insert([[maybe_unused]] size_type count,
+                              [[maybe_unused]] size_type idx) const noexcept {
+    if (count * sizeof(T) >= trace::large_insert_bytes)
+      MY_STL_TRACE(large_insert, this, count, count * sizeof(T), idx);
+  }
+
+  // returns the storage together with the number of slots it really holds,
+  // which may be more than n when the allocator reports its slack
+  constexpr allocation_result<pointer> allocate(size_type n) {
+    if constexpr (requires(allocator_type &a) { a.allocate_at_least(n); }) {
+      auto [ptr, count] = m_alloc.allocate_at_least(n);
+      return {ptr, count};
+    } else {
+      return {alloc_traits::allocate(m_alloc, n), n};
+    }
+  }
+
+  constexpr void deallocate(pointer p, size_type n) {
+    if (p != nullptr)
+      alloc_traits::deallocate(m_alloc, p, n);
+  }
 
   pointer m_data;
   size_type m_size;
   size_type m_capacity;
+  [[no_unique_address]] allocator_type m_alloc;
 
 public:
   // for debug
@@ -60,95 +439,175 @@ public:
   }
 
   // ctor
-  constexpr vector() noexcept : m_data{}, m_size{}, m_capacity{} {}
-  explicit vector(size_type count) : vector(count, T{}) {}
-  constexpr vector(size_type count, const_reference value) {
-    m_data = allocate(count);
+  constexpr vector() noexcept(noexcept(Allocator())) : vector(Allocator()) {}
+  constexpr explicit vector(const Allocator &alloc) noexcept
+      : m_data{}, m_size{}, m_capacity{}, m_alloc{alloc} {}
+  constexpr explicit vector(size_type count,
+                            const Allocator &alloc = Allocator())
+      : m_data{}, m_size{}, m_capacity{}, m_alloc{alloc} {
+    auto [ptr, cap] = allocate(count);
+    m_data = ptr;
     try {
-      std::uninitialized_fill_n(begin(), count, value);
-      m_size = m_capacity = count;
+      detail::uninitialized_value_construct_n(m_data, count);
+      m_size = count;
+      m_capacity = cap;
     } catch (...) {
-      deallocate(m_data);
+      deallocate(ptr, cap);
+      m_data = nullptr;
       throw;
     }
   }
-
-  template <container_compatible_range<T> R>
-  constexpr vector(std::from_range_t, R &&rg)
-      : m_data{}, m_size{}, m_capacity{} {
-    if constexpr (stdr::sized_range<R>) {
-      // Wow, we use if constexpr with concept!
-      // Can you see how "mordern" we are?
-      reserve(stdr::size(rg));
-    }
-
-    for (auto &&e : rg) {
-      push_back(std::forward<decltype(e)>(e));
+  constexpr vector(default_init_t, size_type count,
+                   const Allocator &alloc = Allocator())
+      : m_data{}, m_size{}, m_capacity{}, m_alloc{alloc} {
+    auto [ptr, cap] = allocate(count);
+    m_data = ptr;
+    try {
+      detail::uninitialized_default_construct_n(m_data, count);
+      m_size = count;
+      m_capacity = cap;
+    } catch (...) {
+      deallocate(ptr, cap);
+      m_data = nullptr;
+      throw;
     }
   }
-
-  template <class InputIt> constexpr vector(InputIt first, InputIt last) {
-    auto count = static_cast<size_type>(std::distance(first, last));
-    m_data = allocate(count);
-    auto constructed_end = m_data;
+  constexpr vector(size_type count, const_reference value,
+                   const Allocator &alloc = Allocator())
+      : m_data{}, m_size{}, m_capacity{}, m_alloc{alloc} {
+    auto [ptr, cap] = allocate(count);
+    m_data = ptr;
     try {
-      constructed_end = std::uninitialized_copy(first, last, m_data);
-      m_size = m_capacity = count;
+      detail::uninitialized_fill_n(begin(), count, value);
+      m_size = count;
+      m_capacity = cap;
     } catch (...) {
-      std::destroy(m_data, constructed_end);
-      deallocate(m_data);
+      deallocate(ptr, cap);
+      m_data = nullptr;
       throw;
     }
   }
 
-  // copy ctor
-  vector(const vector &other) {
-    size_type count = other.size();
-    m_data = allocate(count);
-    auto constructed_end = m_data;
+  template <container_compatible_range<T> R>
+  constexpr vector(std::from_range_t, R &&rg,
+                   const Allocator &alloc = Allocator())
+      : m_data{}, m_size{}, m_capacity{}, m_alloc{alloc} {
+    append_range(std::forward<R>(rg));
+  }
+
+  template <class InputIt>
+  constexpr vector(InputIt first, InputIt last,
+                   const Allocator &alloc = Allocator())
+      : m_data{}, m_size{}, m_capacity{}, m_alloc{alloc} {
+    auto count = static_cast<size_type>(std::distance(first, last));
+    auto [ptr, cap] = allocate(count);
+    m_data = ptr;
     try {
-      constructed_end =
-          std::uninitialized_copy(other.cbegin(), other.cend(), m_data);
-      m_size = m_capacity = count;
+      detail::uninitialized_copy(first, last, m_data);
+      m_size = count;
+      m_capacity = cap;
     } catch (...) {
-      std::destroy(m_data, constructed_end);
-      deallocate(m_data);
+      deallocate(ptr, cap);
+      m_data = nullptr;
       throw;
     }
   }
 
-  // move ctor
-  vector(vector &&other) noexcept {
-    m_data = other.m_data;
-    m_size = other.m_size;
-    m_capacity = other.m_capacity;
-    other.m_data = nullptr;
-    other.m_size = other.m_capacity = 0;
+  // copy ctor
+  constexpr vector(const vector &other)
+      : vector(other, alloc_traits::select_on_container_copy_construction(
+                          other.m_alloc)) {}
+
+  constexpr vector(const vector &other, const Allocator &alloc)
+      : vector(other.cbegin(), other.cend(), alloc) {}
+
+  // parallel ctors: elements are built in chunks on the shared thread pool,
+  // which also spreads the first-touch page faults over all cores
+  vector(execution::parallel_policy, size_type count,
+         const Allocator &alloc = Allocator())
+      : vector(alloc) {
+    parallel_construct(count, [](pointer b, pointer e, size_type) {
+      std::uninitialized_value_construct(b, e);
+    });
+  }
+
+  vector(execution::parallel_policy, size_type count, const_reference value,
+         const Allocator &alloc = Allocator())
+      : vector(alloc) {
+    parallel_construct(count, [&value](pointer b, pointer e, size_type) {
+      std::uninitialized_fill(b, e, value);
+    });
+  }
+
+  vector(execution::parallel_policy, const vector &other)
+      : vector(alloc_traits::select_on_container_copy_construction(
+            other.m_alloc)) {
+    auto src = other.data();
+    parallel_construct(other.size(),
+                       [src](pointer b, pointer e, size_type off) {
+                         std::uninitialized_copy(src + off,
+                                                 src + off + (e - b), b);
+                       });
   }
 
+  // move ctor
+  constexpr vector(vector &&other) noexcept
+      : m_data{std::exchange(other.m_data, nullptr)},
+        m_size{std::exchange(other.m_size, 0)},
+        m_capacity{std::exchange(other.m_capacity, 0)},
+        m_alloc{std::move(other.m_alloc)} {}
+
   // initializer list
-  vector(std::initializer_list<value_type> ilist)
-      : vector(ilist.begin(), ilist.end()) {}
+  constexpr vector(std::initializer_list<value_type> ilist,
+                   const Allocator &alloc = Allocator())
+      : vector(ilist.begin(), ilist.end(), alloc) {}
 
   // dtor
-  ~vector() {
+  constexpr ~vector() {
     std::destroy(begin(), end());
-    deallocate(m_data);
+    deallocate(m_data, m_capacity);
   }
 
   // member functions
+  // the copy is built with the allocator this vector ends up with, so the
+  // swap never leaves storage with an allocator that didn't make it
   constexpr vector &operator=(const vector &other) {
     if (this != &other) {
-      vector temp(other);
+      constexpr bool propagate =
+          alloc_traits::propagate_on_container_copy_assignment::value;
+      vector temp(other, propagate ? other.m_alloc : m_alloc);
       swap(temp);
+      if constexpr (propagate &&
+                    !alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, temp.m_alloc);
+      }
     }
     return *this;
   }
 
-  constexpr vector &operator=(vector &&other) noexcept {
+  constexpr vector &operator=(vector &&other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
     if (this != &other) {
+      if constexpr (!alloc_traits::propagate_on_container_move_assignment::
+                        value &&
+                    !alloc_traits::is_always_equal::value) {
+        // storage of an unequal allocator can't be adopted, move elementwise
+        if (m_alloc != other.m_alloc) {
+          clear();
+          reserve(other.size());
+          detail::uninitialized_move(other.begin(), other.end(), m_data);
+          m_size = other.size();
+          other.clear();
+          return *this;
+        }
+      }
       std::destroy(begin(), end());
-      deallocate(m_data);
+      deallocate(m_data, m_capacity);
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                        value) {
+        m_alloc = std::move(other.m_alloc);
+      }
       m_data = other.m_data;
       m_size = other.m_size;
       m_capacity = other.m_capacity;
@@ -158,12 +617,14 @@ public:
     return *this;
   }
 
-  vector &operator=(std::initializer_list<value_type> ilist) {
-    vector temp(ilist);
+  constexpr vector &operator=(std::initializer_list<value_type> ilist) {
+    vector temp(ilist, m_alloc);
     swap(temp);
     return *this;
   }
 
+  constexpr allocator_type get_allocator() const noexcept { return m_alloc; }
+
   // element access
   constexpr reference at(size_type pos) {
     if (pos >= size()) {
@@ -235,12 +696,24 @@ public:
           "my::vector::reserve: can't reserve space greater than max_size()!");
     if (capacity() >= new_cap)
       return;
-    pointer new_data = allocate(new_cap);
-    std::uninitialized_move(begin(), end(), new_data);
-    std::destroy(begin(), end());
-    deallocate(m_data);
+    if constexpr (can_reallocate) {
+      auto [new_data, got] = m_alloc.reallocate(m_data, m_capacity, new_cap);
+      MY_STL_TRACE(growth, this, m_capacity, got, size() * sizeof(T));
+      m_data = new_data;
+      m_capacity = got;
+      return;
+    }
+    auto [new_data, got] = allocate(new_cap);
+    try {
+      detail::relocate(begin(), end(), new_data);
+    } catch (...) {
+      deallocate(new_data, got);
+      throw;
+    }
+    MY_STL_TRACE(growth, this, m_capacity, got, size() * sizeof(T));
+    deallocate(m_data, m_capacity);
     m_data = new_data;
-    m_capacity = new_cap;
+    m_capacity = got;
   }
 
   [[nodiscard]] constexpr size_type capacity() const noexcept {
@@ -252,22 +725,36 @@ public:
       return;
 
     if (size() == 0) {
+      MY_STL_TRACE(shrink, this, m_capacity, 0);
       std::destroy(begin(), end());
-      deallocate(m_data);
+      deallocate(m_data, m_capacity);
       m_data = nullptr;
       m_capacity = 0;
       return;
     }
 
-    pointer new_data = allocate(size());
+    if constexpr (can_reallocate) {
+      auto [new_data, got] = m_alloc.reallocate(m_data, m_capacity, size());
+      MY_STL_TRACE(shrink, this, m_capacity, got, size() * sizeof(T));
+      m_data = new_data;
+      m_capacity = got;
+      return;
+    }
+
+    auto [new_data, got] = allocate(size());
+    if (got >= capacity()) {
+      // the allocator can't hand back a tighter block, keep the old one
+      deallocate(new_data, got);
+      return;
+    }
     try {
-      std::uninitialized_move(begin(), end(), new_data);
-      std::destroy(begin(), end());
-      deallocate(m_data);
+      detail::relocate(begin(), end(), new_data);
+      MY_STL_TRACE(shrink, this, m_capacity, got, size() * sizeof(T));
+      deallocate(m_data, m_capacity);
       m_data = new_data;
-      m_capacity = size();
+      m_capacity = got;
     } catch (...) {
-      deallocate(new_data);
+      deallocate(new_data, got);
       throw;
     }
   }
@@ -297,37 +784,35 @@ public:
 
     auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
     auto old_size = size();
-
-    if (count + old_size > capacity()) {
+    trace_insert(count, idx);
+
+    if (count + old_size > capacity() && can_reallocate) {
+      // grow in place; value may live in the storage being resized
+      value_type value_copy = value;
+      reserve(grow_capacity(capacity(), count + old_size));
+      detail::insert_fill_in_place(begin() + idx, end(), count, value_copy);
+    } else if (count + old_size > capacity()) {
       // Case 1: re-allocate new spaces
-      auto new_cap =
-          std::max(count + old_size,
-                   static_cast<size_type>(REALLOCATION_FACTOR * capacity()));
-      pointer new_data = allocate(new_cap);
-      std::uninitialized_move(begin(), begin() + idx, new_data);
-      std::uninitialized_move(begin() + idx, begin() + old_size,
-                              new_data + idx + count);
-      std::uninitialized_fill_n(new_data + idx, count, value);
+      auto [new_data, got] =
+          allocate(grow_capacity(capacity(), count + old_size));
+      try {
+        detail::insert_relocate(
+            begin(), begin() + idx, end(), new_data, count,
+            [&](pointer p) {
+              detail::uninitialized_fill_n(p, count, value);
+            });
+      } catch (...) {
+        deallocate(new_data, got);
+        throw;
+      }
 
-      std::destroy(begin(), end());
-      deallocate(m_data);
+      MY_STL_TRACE(growth, this, m_capacity, got, old_size * sizeof(T));
+      deallocate(m_data, m_capacity);
 
       m_data = new_data;
-      m_capacity = new_cap;
+      m_capacity = got;
     } else {
-      value_type value_copy =
-          value; // Fix self-reference: make a copy of value before reallocation
-      if (count + idx <= old_size) {
-        // Case 2: number of inserted elements are "small"
-        std::uninitialized_move(end() - count, end(), end());
-        std::move_backward(begin() + idx, end() - count, end());
-        std::fill_n(begin() + idx, count, value_copy);
-      } else {
-        // Case 3: number of inserted elements are "large"
-        std::uninitialized_move(begin() + idx, end(), begin() + idx + count);
-        std::fill_n(begin() + idx, old_size - idx, value_copy);
-        std::uninitialized_fill_n(end(), count - (old_size - idx), value_copy);
-      }
+      detail::insert_fill_in_place(begin() + idx, end(), count, value);
     }
     m_size = old_size + count;
     return begin() + idx;
@@ -336,52 +821,90 @@ public:
   template <std::input_iterator InputIt>
   constexpr iterator insert(const_iterator pos, InputIt first, InputIt last) {
     // ub if either first or last are iterators into *this
+    return insert_range(pos, stdr::subrange(first, last));
+  }
+
+  constexpr iterator insert(const_iterator pos,
+                            std::initializer_list<T> ilist) {
+    return insert(pos, ilist.begin(), ilist.end());
+  }
+
+  // Ranges whose size is known up front are inserted with at most one
+  // allocation; unsized input ranges are appended one by one (growing
+  // geometrically) and rotated into place.
+  template <container_compatible_range<T> R>
+  constexpr iterator insert_range(const_iterator pos, R &&rg) {
+    // ub if rg refers to *this
     assert((pos >= cbegin()) && (pos <= cend()));
 
-    if (first == last) {
-      return begin() + std::distance(cbegin(), pos);
+    if constexpr (stdr::forward_range<R> || stdr::sized_range<R>) {
+      auto count = static_cast<size_type>(stdr::distance(rg));
+      return insert_n(pos, range_source(rg), count);
+    } else {
+      auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
+      auto old_size = size();
+      for (auto &&e : rg) {
+        emplace_back(std::forward<decltype(e)>(e));
+      }
+      std::rotate(begin() + idx, begin() + old_size, end());
+      return begin() + idx;
     }
-    auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
-    auto old_size = size();
-    auto count = static_cast<size_type>(std::distance(first, last));
-
-    if (count + old_size > capacity()) {
-      // Case 1: re-allocate new spaces
-      auto new_cap =
-          std::max(count + old_size,
-                   static_cast<size_type>(REALLOCATION_FACTOR * capacity()));
-      pointer new_data = allocate(new_cap);
-      std::uninitialized_move(begin(), begin() + idx, new_data);
-      std::uninitialized_move(begin() + idx, begin() + old_size,
-                              new_data + idx + count);
-      std::uninitialized_copy(first, last, new_data + idx);
+  }
 
-      std::destroy(begin(), end());
-      deallocate(m_data);
+  template <container_compatible_range<T> R>
+  constexpr void append_range(R &&rg) {
+    insert_range(cend(), std::forward<R>(rg));
+  }
 
-      m_data = new_data;
-      m_capacity = new_cap;
+  // replaces the contents with rg, reusing the current storage whenever it
+  // is large enough
+  template <container_compatible_range<T> R>
+  constexpr void assign_range(R &&rg) {
+    if constexpr (stdr::forward_range<R> || stdr::sized_range<R>) {
+      auto count = static_cast<size_type>(stdr::distance(rg));
+      auto src = range_source(rg);
+
+      if (count > capacity()) {
+        // nothing to reuse, build the result in storage of the right size
+        auto [new_data, got] = allocate(count);
+        try {
+          detail::uninitialized_copy_n(src, count, new_data);
+        } catch (...) {
+          deallocate(new_data, got);
+          throw;
+        }
+        std::destroy(begin(), end());
+        deallocate(m_data, m_capacity);
+        m_data = new_data;
+        m_size = count;
+        m_capacity = got;
+        return;
+      }
 
-    } else {
-      if (count + idx <= old_size) {
-        // Case 2: number of inserted elements are "small"
-        std::uninitialized_move(end() - count, end(), end());
-        std::move_backward(begin() + idx, end() - count, end());
-        std::copy(first, last, begin() + idx);
+      auto overlap = std::min(count, size());
+      src = stdr::copy_n(src, static_cast<difference_type>(overlap), begin())
+                .in;
+      if (count > size()) {
+        detail::uninitialized_copy_n(src, count - size(), end());
       } else {
-        // Case 3: number of inserted elements are "large"
-        std::uninitialized_move(begin() + idx, end(), begin() + idx + count);
-        std::copy(first, first + old_size - idx, begin() + idx);
-        std::uninitialized_copy(first + old_size - idx, last, end());
+        std::destroy(begin() + count, end());
+      }
+      m_size = count;
+    } else {
+      auto it = begin();
+      auto first = stdr::begin(rg);
+      auto last = stdr::end(rg);
+      for (; first != last && it != end(); ++first, ++it) {
+        *it = *first;
+      }
+      if (it != end()) {
+        std::destroy(it, end());
+        m_size = static_cast<size_type>(it - begin());
+      }
+      for (; first != last; ++first) {
+        emplace_back(*first);
       }
     }
-    m_size = old_size + count;
-    return begin() + idx;
-  }
-
-  constexpr iterator insert(const_iterator pos,
-                            std::initializer_list<T> ilist) {
-    return insert(pos, ilist.begin(), ilist.end());
   }
 
   // emplace
@@ -389,20 +912,19 @@ public:
   constexpr iterator emplace(const_iterator pos, Args &&...args) {
     assert((pos >= cbegin()) && (pos <= cend()));
     auto idx = static_cast<size_type>(std::distance(cbegin(), pos));
-    if (capacity() == size()) {
-      reserve(capacity() == 0
-                  ? 1
-                  : static_cast<size_type>(REALLOCATION_FACTOR * capacity()));
+    if (idx == size()) {
+      emplace_back(std::forward<Args>(args)...);
+      return begin() + idx;
     }
 
-    if (idx < size()) {
-      new (end()) T(std::move(back()));
-      std::move_backward(begin() + idx, end() - 1, end());
-      at(idx) = T(std::forward<Args>(args)...);
-    } else {
-      new (end()) T(std::forward<Args>(args)...);
+    // args may refer to elements that are about to move
+    T temp(std::forward<Args>(args)...);
+    if (capacity() == size()) {
+      reserve(grow_capacity(capacity(), size() + 1));
     }
 
+    detail::emplace_in_place(begin() + idx, end(), std::move(temp));
+
     ++m_size;
     return begin() + idx;
   }
@@ -414,11 +936,9 @@ public:
 
     auto idx = static_cast<size_type>(pos - begin());
 
-    std::move(begin() + idx + 1, end(), begin() + idx);
-
+    detail::erase_in_place(begin() + idx, begin() + idx + 1, end());
     --m_size;
 
-    std::destroy_at(end());
     return begin() + idx;
   }
 
@@ -432,12 +952,9 @@ public:
     auto num_to_erase = static_cast<size_type>(last - first);
     auto idx = static_cast<size_type>(first - begin());
 
-    std::move(begin() + (last - begin()), end(), begin() + idx);
-
+    detail::erase_in_place(begin() + idx, begin() + idx + num_to_erase, end());
     m_size -= num_to_erase;
 
-    std::destroy(end(), end() + num_to_erase);
-
     return begin() + idx;
   }
 
@@ -449,7 +966,7 @@ public:
 
   template <class... Args> constexpr reference emplace_back(Args &&...args) {
     if (capacity() >= size() + 1) {
-      new (end()) T(std::forward<Args>(args)...);
+      std::construct_at(end(), std::forward<Args>(args)...);
       ++m_size;
       return back();
     } else {
@@ -457,13 +974,9 @@ public:
       // self-references
       T temp(std::forward<Args>(args)...);
 
-      size_type new_cap =
-          (capacity() == 0)
-              ? 1
-              : static_cast<size_type>(REALLOCATION_FACTOR * capacity());
-      reserve(new_cap);
+      reserve(grow_capacity(capacity(), size() + 1));
 
-      new (end()) T(std::move(temp));
+      std::construct_at(end(), std::move(temp));
       ++m_size;
       return back();
     }
@@ -483,11 +996,37 @@ public:
       std::destroy(begin() + count, end());
     } else {
       reserve(count);
-      std::uninitialized_fill_n(end(), count - size(), T{});
+      detail::uninitialized_value_construct_n(end(), count - size());
+    }
+    m_size = count;
+  }
+
+  // like resize, but new elements are default-initialized: for trivial types
+  // the memory is left as is, ready to be overwritten by read()/memcpy
+  constexpr void resize_for_overwrite(size_type count) {
+    if (count == size())
+      return;
+    if (count < size()) {
+      std::destroy(begin() + count, end());
+    } else {
+      reserve(count);
+      detail::uninitialized_default_construct_n(end(), count - size());
     }
     m_size = count;
   }
 
+  // grows by count default-initialized elements and returns a pointer to the
+  // first of them; grows geometrically, so repeated appends stay amortized
+  constexpr pointer append_uninitialized(size_type count) {
+    if (size() + count > capacity()) {
+      reserve(grow_capacity(capacity(), size() + count));
+    }
+    auto tail = end();
+    detail::uninitialized_default_construct_n(tail, count);
+    m_size += count;
+    return tail;
+  }
+
   constexpr void resize(size_type count, const T &value) {
     if (count == size())
       return;
@@ -495,13 +1034,44 @@ public:
       std::destroy(begin() + count, end());
     } else {
       reserve(count);
-      std::uninitialized_fill_n(end(), count - size(), value);
+      detail::uninitialized_fill_n(end(), count - size(), value);
+    }
+    m_size = count;
+  }
+
+  void resize(execution::parallel_policy, size_type count) {
+    if (count <= size()) {
+      resize(count);
+      return;
     }
+    reserve(count);
+    detail::parallel_uninitialized(
+        end(), count - size(),
+        [](pointer b, pointer e, size_type) {
+          std::uninitialized_value_construct(b, e);
+        });
+    m_size = count;
+  }
+
+  void resize(execution::parallel_policy, size_type count, const T &value) {
+    if (count <= size()) {
+      resize(count);
+      return;
+    }
+    value_type value_copy = value; // value may move with the reallocation
+    reserve(count);
+    detail::parallel_uninitialized(
+        end(), count - size(), [&value_copy](pointer b, pointer e, size_type) {
+          std::uninitialized_fill(b, e, value_copy);
+        });
     m_size = count;
   }
 
   constexpr void swap(vector &other) noexcept {
     if (this != &other) {
+      if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, other.m_alloc);
+      }
       std::swap(m_data, other.m_data);
       std::swap(m_size, other.m_size);
       std::swap(m_capacity, other.m_capacity);
@@ -510,22 +1080,90 @@ public:
 };
 
 // Non-member functions
-template <class T>
-constexpr auto operator<=>(const vector<T> &lhs, const vector<T> &rhs) {
+// arithmetic elements are scanned with the vector kernels from simd.h
+template <class T, class Alloc, class Growth>
+constexpr auto operator<=>(const vector<T, Alloc, Growth> &lhs,
+                           const vector<T, Alloc, Growth> &rhs) {
+  if constexpr (detail::simd::comparable<T>) {
+    if !consteval {
+      return detail::simd::compare_three_way(lhs.data(), lhs.size(),
+                                             rhs.data(), rhs.size());
+    }
+  }
   return std::lexicographical_compare_three_way(lhs.begin(), lhs.end(),
                                                 rhs.begin(), rhs.end());
 }
 
-template <class T>
-constexpr bool operator==(const vector<T> &lhs, const vector<T> &rhs) {
+template <class T, class Alloc, class Growth>
+constexpr bool operator==(const vector<T, Alloc, Growth> &lhs,
+                          const vector<T, Alloc, Growth> &rhs) {
+  if constexpr (detail::simd::comparable<T>) {
+    if !consteval {
+      return detail::simd::equal(lhs.data(), lhs.size(), rhs.data(),
+                                 rhs.size());
+    }
+  }
   return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
+
+// Removes every element satisfying pred in one compacting pass and returns
+// how many were removed. Small trivially copyable elements take the
+// vectorized compaction kernel from simd.h.
+template <class T, class Alloc, class Growth, class Pred>
+constexpr typename vector<T, Alloc, Growth>::size_type
+erase_if(vector<T, Alloc, Growth> &c, Pred pred) {
+  auto old_size = c.size();
+  if constexpr (detail::simd::compactable<T>) {
+    if !consteval {
+      auto kept = detail::simd::compact(
+          c.data(), old_size,
+          [&pred](const T &elem) { return !static_cast<bool>(pred(elem)); });
+      c.erase(c.begin() + kept, c.end());
+      return old_size - kept;
+    }
+  }
+  c.erase(std::remove_if(c.begin(), c.end(), std::ref(pred)), c.end());
+  return old_size - c.size();
+}
+
+template <class T, class Alloc, class Growth, class U = T>
+constexpr typename vector<T, Alloc, Growth>::size_type
+erase(vector<T, Alloc, Growth> &c, const U &value) {
+  return erase_if(c, [&value](const T &elem) { return elem == value; });
+}
+// Copies the vector built by the constant expression Make() into a
+// std::array. The vector's storage can't outlive constant evaluation but the
+// array can, so a lookup table computed this way is stored in the binary
+// instead of being built at startup:
+//
+//   constexpr auto squares = my::freeze<[] {
+//     my::vector<int> v;
+//     for (int i = 0; i < 256; ++i)
+//       v.push_back(i * i);
+//     return v;
+//   }>();
+template <auto Make> consteval auto freeze() {
+  using value_type = typename decltype(Make())::value_type;
+  std::array<value_type, Make().size()> table{};
+  auto v = Make();
+  std::copy(v.begin(), v.end(), table.begin());
+  return table;
+}
+
+// vector whose data() is aligned to at least Align bytes, e.g. 64 so that
+// aligned SIMD loads work and per-thread slices start on their own cache line
+template <class T, std::size_t Align, growth_policy Growth = default_growth>
+using aligned_vector = vector<T, allocator<T, Align>, Growth>;
+
 // deduction guide
-template< class InputIt>
-vector(InputIt, InputIt) -> vector<typename std::iterator_traits<InputIt>::value_type>;
+template< class InputIt, class Alloc = allocator<typename std::iterator_traits<InputIt>::value_type>>
+vector(InputIt, InputIt, Alloc = Alloc()) -> vector<typename std::iterator_traits<InputIt>::value_type, Alloc>;
 template< class T >
 concept input_range =
     stdr::range<T> && std::input_iterator<stdr::iterator_t<T>>;
-template<input_range R>
-vector(std::from_range_t, R&&) -> vector<stdr::range_value_t<R>>;
+template<input_range R, class Alloc = allocator<stdr::range_value_t<R>>>
+vector(std::from_range_t, R&&, Alloc = Alloc()) -> vector<stdr::range_value_t<R>, Alloc>;
 } // namespace my
+
+// packed specialization for vector<bool>
+#include "vector_bool.h"
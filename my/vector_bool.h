@@ -0,0 +1,651 @@
+#pragma once
+#include "vector.h"
+#include <algorithm>
+#include <bit>
+#include <compare>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <memory>
+#include <ranges>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace my {
+
+// Bit-packed vector<bool>: 64 flags per word behind proxy references, plus
+// algorithms that work a whole word at a time (count, find_first/find_next,
+// rank, and/or/xor between vectors). Bits past size() in the last word are
+// always zero, so those algorithms never need to mask them out.
+template <class Allocator, growth_policy Growth>
+class vector<bool, Allocator, Growth> {
+public:
+  using word_type = std::uint64_t;
+  using value_type = bool;
+  using allocator_type = Allocator;
+  using size_type = std::size_t;
+  using difference_type = std::ptrdiff_t;
+  using const_reference = bool;
+
+  static constexpr size_type bits_per_word = 64;
+  // returned by find_first/find_next when there is no set bit
+  static constexpr size_type npos = static_cast<size_type>(-1);
+
+  class reference {
+    friend class vector;
+    template <bool> friend class bit_iterator;
+
+    constexpr reference(word_type *word, word_type mask) noexcept
+        : m_word{word}, m_mask{mask} {}
+
+  public:
+    constexpr reference(const reference &) noexcept = default;
+
+    constexpr operator bool() const noexcept {
+      return (*m_word & m_mask) != 0;
+    }
+    constexpr bool operator~() const noexcept { return !bool(*this); }
+
+    // const so that the proxy models std::indirectly_writable
+    constexpr const reference &operator=(bool x) const noexcept {
+      if (x) {
+        *m_word |= m_mask;
+      } else {
+        *m_word &= ~m_mask;
+      }
+      return *this;
+    }
+    constexpr const reference &operator=(const reference &x) const noexcept {
+      return *this = bool(x);
+    }
+    constexpr reference &operator=(bool x) noexcept {
+      std::as_const(*this) = x;
+      return *this;
+    }
+    constexpr reference &operator=(const reference &x) noexcept {
+      return *this = bool(x);
+    }
+
+    constexpr void flip() const noexcept { *m_word ^= m_mask; }
+
+    friend constexpr void swap(reference a, reference b) noexcept {
+      bool tmp = a;
+      a = bool(b);
+      b = tmp;
+    }
+
+  private:
+    word_type *m_word;
+    word_type m_mask;
+  };
+
+  template <bool Const> class bit_iterator {
+    template <bool> friend class bit_iterator;
+    using word_pointer =
+        std::conditional_t<Const, const word_type *, word_type *>;
+
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using iterator_concept = std::random_access_iterator_tag;
+    using value_type = bool;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference =
+        std::conditional_t<Const, bool, typename vector::reference>;
+
+    constexpr bit_iterator() noexcept = default;
+    constexpr bit_iterator(word_pointer words, difference_type pos) noexcept
+        : m_words{words}, m_pos{pos} {}
+    template <bool C = Const>
+      requires C
+    constexpr bit_iterator(const bit_iterator<false> &other) noexcept
+        : m_words{other.m_words}, m_pos{other.m_pos} {}
+
+    constexpr reference operator*() const noexcept {
+      auto bit = static_cast<size_type>(m_pos);
+      auto *word = m_words + bit / bits_per_word;
+      auto mask = word_type{1} << (bit % bits_per_word);
+      if constexpr (Const) {
+        return (*word & mask) != 0;
+      } else {
+        return reference(word, mask);
+      }
+    }
+    constexpr reference operator[](difference_type n) const noexcept {
+      return *(*this + n);
+    }
+
+    constexpr bit_iterator &operator++() noexcept {
+      ++m_pos;
+      return *this;
+    }
+    constexpr bit_iterator operator++(int) noexcept {
+      auto tmp = *this;
+      ++m_pos;
+      return tmp;
+    }
+    constexpr bit_iterator &operator--() noexcept {
+      --m_pos;
+      return *this;
+    }
+    constexpr bit_iterator operator--(int) noexcept {
+      auto tmp = *this;
+      --m_pos;
+      return tmp;
+    }
+    constexpr bit_iterator &operator+=(difference_type n) noexcept {
+      m_pos += n;
+      return *this;
+    }
+    constexpr bit_iterator &operator-=(difference_type n) noexcept {
+      m_pos -= n;
+      return *this;
+    }
+    friend constexpr bit_iterator operator+(bit_iterator it,
+                                            difference_type n) noexcept {
+      return it += n;
+    }
+    friend constexpr bit_iterator operator+(difference_type n,
+                                            bit_iterator it) noexcept {
+      return it += n;
+    }
+    friend constexpr bit_iterator operator-(bit_iterator it,
+                                            difference_type n) noexcept {
+      return it -= n;
+    }
+    friend constexpr difference_type operator-(const bit_iterator &a,
+                                               const bit_iterator &b) noexcept {
+      return a.m_pos - b.m_pos;
+    }
+    friend constexpr bool operator==(const bit_iterator &a,
+                                     const bit_iterator &b) noexcept {
+      return a.m_pos == b.m_pos;
+    }
+    friend constexpr auto operator<=>(const bit_iterator &a,
+                                      const bit_iterator &b) noexcept {
+      return a.m_pos <=> b.m_pos;
+    }
+
+  private:
+    word_pointer m_words = nullptr;
+    difference_type m_pos = 0;
+  };
+
+  using iterator = bit_iterator<false>;
+  using const_iterator = bit_iterator<true>;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+private:
+  using word_allocator = typename std::allocator_traits<
+      Allocator>::template rebind_alloc<word_type>;
+  using alloc_traits = std::allocator_traits<word_allocator>;
+
+  static constexpr size_type words_for(size_type bits) noexcept {
+    return (bits + bits_per_word - 1) / bits_per_word;
+  }
+
+  // mask of the bits below `bits` in a word, all ones for a multiple of 64
+  static constexpr word_type low_mask(size_type bits) noexcept {
+    auto rem = bits % bits_per_word;
+    return rem == 0 ? ~word_type{0} : (word_type{1} << rem) - 1;
+  }
+
+  allocation_result<word_type *> allocate(size_type n) {
+    if constexpr (requires(word_allocator &a) { a.allocate_at_least(n); }) {
+      auto [ptr, count] = m_alloc.allocate_at_least(n);
+      return {ptr, count};
+    } else {
+      return {alloc_traits::allocate(m_alloc, n), n};
+    }
+  }
+
+  void deallocate(word_type *p, size_type n) {
+    if (p != nullptr)
+      alloc_traits::deallocate(m_alloc, p, n);
+  }
+
+  // moves the words in use into a block of at least `words` words
+  void reallocate(size_type words) {
+    auto [ptr, got] = allocate(words);
+    if (m_size != 0)
+      std::memcpy(ptr, m_words, words_for(m_size) * sizeof(word_type));
+    deallocate(m_words, m_capacity);
+    m_words = ptr;
+    m_capacity = got;
+  }
+
+  // sets bits [first, last) to value a word at a time
+  void fill_bits(size_type first, size_type last, bool value) noexcept {
+    if (first >= last)
+      return;
+    auto fw = first / bits_per_word;
+    auto lw = (last - 1) / bits_per_word;
+    auto head = ~word_type{0} << (first % bits_per_word);
+    auto tail = low_mask(last);
+    auto apply = [&](word_type &w, word_type mask) {
+      w = value ? (w | mask) : (w & ~mask);
+    };
+    if (fw == lw) {
+      apply(m_words[fw], head & tail);
+      return;
+    }
+    apply(m_words[fw], head);
+    std::fill(m_words + fw + 1, m_words + lw, value ? ~word_type{0} : 0);
+    apply(m_words[lw], tail);
+  }
+
+  // grows to new_size bits, the new ones set to value
+  void grow(size_type new_size, bool value) {
+    auto needed = words_for(new_size);
+    if (needed > m_capacity) {
+      if (new_size > max_size())
+        throw std::length_error("my::vector<bool>: size exceeds max_size()");
+      reallocate(Growth::next_capacity(m_capacity, needed, sizeof(word_type)));
+    }
+    auto used = words_for(m_size);
+    std::fill(m_words + used, m_words + needed, word_type{0});
+    fill_bits(m_size, new_size, value);
+    m_size = new_size;
+  }
+
+  void shrink(size_type new_size) noexcept {
+    m_size = new_size;
+    if (m_size % bits_per_word != 0)
+      m_words[m_size / bits_per_word] &= low_mask(m_size);
+  }
+
+  word_type *m_words;
+  size_type m_size;     // in bits
+  size_type m_capacity; // in words
+  [[no_unique_address]] word_allocator m_alloc;
+
+public:
+  // ctor
+  vector() noexcept(noexcept(Allocator())) : vector(Allocator()) {}
+  explicit vector(const Allocator &alloc) noexcept
+      : m_words{}, m_size{}, m_capacity{}, m_alloc{alloc} {}
+  explicit vector(size_type count, const Allocator &alloc = Allocator())
+      : vector(count, false, alloc) {}
+  vector(size_type count, bool value, const Allocator &alloc = Allocator())
+      : vector(alloc) {
+    assign(count, value);
+  }
+
+  template <std::input_iterator InputIt>
+  vector(InputIt first, InputIt last, const Allocator &alloc = Allocator())
+      : vector(alloc) {
+    assign(first, last);
+  }
+
+  template <container_compatible_range<bool> R>
+  vector(std::from_range_t, R &&rg, const Allocator &alloc = Allocator())
+      : vector(alloc) {
+    append_range(std::forward<R>(rg));
+  }
+
+  vector(std::initializer_list<bool> ilist,
+         const Allocator &alloc = Allocator())
+      : vector(ilist.begin(), ilist.end(), alloc) {}
+
+  // copy ctor
+  vector(const vector &other)
+      : vector(other, alloc_traits::select_on_container_copy_construction(
+                          other.m_alloc)) {}
+
+  vector(const vector &other, const Allocator &alloc) : vector(alloc) {
+    if (other.m_size == 0)
+      return;
+    auto [ptr, got] = allocate(words_for(other.m_size));
+    std::memcpy(ptr, other.m_words,
+                words_for(other.m_size) * sizeof(word_type));
+    m_words = ptr;
+    m_capacity = got;
+    m_size = other.m_size;
+  }
+
+  // move ctor
+  vector(vector &&other) noexcept
+      : m_words{std::exchange(other.m_words, nullptr)},
+        m_size{std::exchange(other.m_size, 0)},
+        m_capacity{std::exchange(other.m_capacity, 0)},
+        m_alloc{std::move(other.m_alloc)} {}
+
+  // dtor
+  ~vector() { deallocate(m_words, m_capacity); }
+
+  vector &operator=(const vector &other) {
+    if (this != &other) {
+      vector temp(other);
+      swap(temp);
+    }
+    return *this;
+  }
+
+  vector &operator=(vector &&other) noexcept(
+      alloc_traits::propagate_on_container_move_assignment::value ||
+      alloc_traits::is_always_equal::value) {
+    if (this != &other) {
+      if constexpr (!alloc_traits::propagate_on_container_move_assignment::
+                        value &&
+                    !alloc_traits::is_always_equal::value) {
+        // storage of an unequal allocator can't be adopted, copy the words
+        if (m_alloc != other.m_alloc) {
+          vector temp(other, get_allocator());
+          swap(temp);
+          other.clear();
+          return *this;
+        }
+      }
+      deallocate(m_words, m_capacity);
+      if constexpr (alloc_traits::propagate_on_container_move_assignment::
+                        value) {
+        m_alloc = std::move(other.m_alloc);
+      }
+      m_words = std::exchange(other.m_words, nullptr);
+      m_size = std::exchange(other.m_size, 0);
+      m_capacity = std::exchange(other.m_capacity, 0);
+    }
+    return *this;
+  }
+
+  vector &operator=(std::initializer_list<bool> ilist) {
+    assign(ilist.begin(), ilist.end());
+    return *this;
+  }
+
+  void assign(size_type count, bool value) {
+    clear();
+    grow(count, value);
+  }
+
+  template <std::input_iterator InputIt>
+  void assign(InputIt first, InputIt last) {
+    clear();
+    if constexpr (std::forward_iterator<InputIt>) {
+      reserve(static_cast<size_type>(std::distance(first, last)));
+    }
+    for (; first != last; ++first) {
+      push_back(static_cast<bool>(*first));
+    }
+  }
+
+  allocator_type get_allocator() const noexcept {
+    return allocator_type(m_alloc);
+  }
+
+  // element access
+  reference at(size_type pos) {
+    if (pos >= size()) {
+      throw std::out_of_range("my::vector<bool>::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  const_reference at(size_type pos) const {
+    if (pos >= size()) {
+      throw std::out_of_range("my::vector<bool>::at: index out of range");
+    }
+    return (*this)[pos];
+  }
+  reference operator[](size_type pos) {
+    return reference(m_words + pos / bits_per_word,
+                     word_type{1} << (pos % bits_per_word));
+  }
+  const_reference operator[](size_type pos) const {
+    return (m_words[pos / bits_per_word] >> (pos % bits_per_word) & 1) != 0;
+  }
+  reference front() { return (*this)[0]; }
+  const_reference front() const { return (*this)[0]; }
+  reference back() { return (*this)[m_size - 1]; }
+  const_reference back() const { return (*this)[m_size - 1]; }
+
+  // the packed storage, words_for(size()) words
+  word_type *words() noexcept { return m_words; }
+  const word_type *words() const noexcept { return m_words; }
+  size_type word_count() const noexcept { return words_for(m_size); }
+
+  // iterators
+  iterator begin() noexcept { return iterator(m_words, 0); }
+  const_iterator begin() const noexcept { return const_iterator(m_words, 0); }
+  const_iterator cbegin() const noexcept { return begin(); }
+  iterator end() noexcept {
+    return iterator(m_words, static_cast<difference_type>(m_size));
+  }
+  const_iterator end() const noexcept {
+    return const_iterator(m_words, static_cast<difference_type>(m_size));
+  }
+  const_iterator cend() const noexcept { return end(); }
+  reverse_iterator rbegin() noexcept { return reverse_iterator(end()); }
+  const_reverse_iterator rbegin() const noexcept {
+    return const_reverse_iterator(end());
+  }
+  const_reverse_iterator crbegin() const noexcept { return rbegin(); }
+  reverse_iterator rend() noexcept { return reverse_iterator(begin()); }
+  const_reverse_iterator rend() const noexcept {
+    return const_reverse_iterator(begin());
+  }
+  const_reverse_iterator crend() const noexcept { return rend(); }
+
+  // capacity
+  [[nodiscard]] bool empty() const noexcept { return m_size == 0; }
+  [[nodiscard]] size_type size() const noexcept { return m_size; }
+  [[nodiscard]] size_type max_size() const noexcept {
+    auto words = std::min<size_type>(alloc_traits::max_size(m_alloc),
+                                     std::numeric_limits<difference_type>::max() /
+                                         bits_per_word);
+    return words * bits_per_word;
+  }
+  void reserve(size_type new_cap) {
+    if (new_cap > max_size())
+      throw std::length_error(
+          "my::vector<bool>::reserve: can't reserve space greater than "
+          "max_size()!");
+    if (words_for(new_cap) > m_capacity)
+      reallocate(words_for(new_cap));
+  }
+  [[nodiscard]] size_type capacity() const noexcept {
+    return m_capacity * bits_per_word;
+  }
+  void shrink_to_fit() {
+    if (words_for(m_size) == m_capacity)
+      return;
+    if (m_size == 0) {
+      deallocate(m_words, m_capacity);
+      m_words = nullptr;
+      m_capacity = 0;
+      return;
+    }
+    reallocate(words_for(m_size));
+  }
+
+  // modifiers
+  void clear() noexcept { m_size = 0; }
+
+  void push_back(bool value) {
+    if (m_size % bits_per_word == 0) {
+      grow(m_size + 1, value);
+      return;
+    }
+    (*this)[m_size++] = value;
+  }
+
+  template <class... Args> reference emplace_back(Args &&...args) {
+    push_back(bool(std::forward<Args>(args)...));
+    return back();
+  }
+
+  void pop_back() {
+    if (empty())
+      return;
+    shrink(m_size - 1);
+  }
+
+  void resize(size_type count, bool value = false) {
+    if (count > m_size) {
+      grow(count, value);
+    } else {
+      shrink(count);
+    }
+  }
+
+  template <container_compatible_range<bool> R> void append_range(R &&rg) {
+    if constexpr (stdr::sized_range<R>) {
+      reserve(m_size + static_cast<size_type>(stdr::size(rg)));
+    }
+    for (auto &&value : rg) {
+      push_back(static_cast<bool>(value));
+    }
+  }
+
+  iterator insert(const_iterator pos, bool value) {
+    return insert(pos, 1, value);
+  }
+
+  iterator insert(const_iterator pos, size_type count, bool value) {
+    auto idx = static_cast<size_type>(pos - cbegin());
+    auto old_size = m_size;
+    grow(m_size + count, false);
+    std::copy_backward(begin() + static_cast<difference_type>(idx),
+                       begin() + static_cast<difference_type>(old_size), end());
+    fill_bits(idx, idx + count, value);
+    return begin() + static_cast<difference_type>(idx);
+  }
+
+  iterator erase(const_iterator pos) { return erase(pos, pos + 1); }
+
+  iterator erase(const_iterator first, const_iterator last) {
+    auto idx = first - cbegin();
+    auto it = begin() + idx;
+    auto new_end = std::copy(begin() + (last - cbegin()), end(), it);
+    shrink(static_cast<size_type>(new_end - begin()));
+    return it;
+  }
+
+  void swap(vector &other) noexcept {
+    if (this != &other) {
+      if constexpr (alloc_traits::propagate_on_container_swap::value) {
+        std::swap(m_alloc, other.m_alloc);
+      }
+      std::swap(m_words, other.m_words);
+      std::swap(m_size, other.m_size);
+      std::swap(m_capacity, other.m_capacity);
+    }
+  }
+
+  static void swap(reference a, reference b) noexcept {
+    bool tmp = a;
+    a = bool(b);
+    b = tmp;
+  }
+
+  // inverts every bit
+  void flip() noexcept {
+    auto n = words_for(m_size);
+    for (size_type i = 0; i < n; ++i) {
+      m_words[i] = ~m_words[i];
+    }
+    shrink(m_size);
+  }
+
+  // word-at-a-time algorithms
+
+  // number of set bits
+  [[nodiscard]] size_type count() const noexcept { return rank(m_size); }
+
+  // number of set bits in [0, pos)
+  [[nodiscard]] size_type rank(size_type pos) const noexcept {
+    auto full = pos / bits_per_word;
+    size_type n = 0;
+    for (size_type i = 0; i < full; ++i) {
+      n += static_cast<size_type>(std::popcount(m_words[i]));
+    }
+    if (pos % bits_per_word != 0)
+      n += static_cast<size_type>(std::popcount(m_words[full] & low_mask(pos)));
+    return n;
+  }
+
+  // index of the first set bit, or npos
+  [[nodiscard]] size_type find_first() const noexcept {
+    return scan_from(0, ~word_type{0});
+  }
+
+  // index of the first set bit after pos, or npos
+  [[nodiscard]] size_type find_next(size_type pos) const noexcept {
+    if (pos + 1 >= m_size)
+      return npos;
+    ++pos;
+    return scan_from(pos / bits_per_word, ~word_type{0}
+                                              << (pos % bits_per_word));
+  }
+
+  // elementwise and/or/xor with a vector of the same size
+  vector &operator&=(const vector &other) {
+    return combine(other, [](word_type a, word_type b) { return a & b; });
+  }
+  vector &operator|=(const vector &other) {
+    return combine(other, [](word_type a, word_type b) { return a | b; });
+  }
+  vector &operator^=(const vector &other) {
+    return combine(other, [](word_type a, word_type b) { return a ^ b; });
+  }
+
+  friend vector operator&(vector lhs, const vector &rhs) { return lhs &= rhs; }
+  friend vector operator|(vector lhs, const vector &rhs) { return lhs |= rhs; }
+  friend vector operator^(vector lhs, const vector &rhs) { return lhs ^= rhs; }
+
+  friend bool operator==(const vector &lhs, const vector &rhs) noexcept {
+    return lhs.m_size == rhs.m_size &&
+           (lhs.m_size == 0 ||
+            std::memcmp(lhs.m_words, rhs.m_words,
+                        words_for(lhs.m_size) * sizeof(word_type)) == 0);
+  }
+
+  // lexicographical, false < true; the first differing bit is the lowest set
+  // bit of the xor of the first differing words
+  friend std::strong_ordering operator<=>(const vector &lhs,
+                                          const vector &rhs) noexcept {
+    auto common = std::min(lhs.m_size, rhs.m_size);
+    auto n = words_for(common);
+    for (size_type i = 0; i < n; ++i) {
+      auto diff = lhs.m_words[i] ^ rhs.m_words[i];
+      if (i + 1 == n)
+        diff &= low_mask(common);
+      if (diff != 0) {
+        auto bit = i * bits_per_word +
+                   static_cast<size_type>(std::countr_zero(diff));
+        return lhs[bit] <=> rhs[bit];
+      }
+    }
+    return lhs.m_size <=> rhs.m_size;
+  }
+
+private:
+  size_type scan_from(size_type word, word_type first_mask) const noexcept {
+    auto n = words_for(m_size);
+    if (word >= n)
+      return npos;
+    auto w = m_words[word] & first_mask;
+    while (w == 0) {
+      if (++word == n)
+        return npos;
+      w = m_words[word];
+    }
+    return word * bits_per_word + static_cast<size_type>(std::countr_zero(w));
+  }
+
+  template <class Op> vector &combine(const vector &other, Op op) {
+    if (other.m_size != m_size)
+      throw std::invalid_argument(
+          "my::vector<bool>: bitwise operands differ in size");
+    auto n = words_for(m_size);
+    for (size_type i = 0; i < n; ++i) {
+      m_words[i] = op(m_words[i], other.m_words[i]);
+    }
+    return *this;
+  }
+};
+} // namespace my
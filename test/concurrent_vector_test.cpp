@@ -0,0 +1,92 @@
+#include "../my/concurrent_vector.h"
+#include <algorithm>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace my;
+
+TEST(ConcurrentVectorTest, ConcurrentPushTest) {
+  constexpr int threads = 8;
+  constexpr int per_thread = 50'000;
+  concurrent_vector<int> v;
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < threads; ++t) {
+    writers.emplace_back([&v, t] {
+      for (int i = 0; i < per_thread; ++i) {
+        auto it = v.push_back(t * per_thread + i);
+        EXPECT_EQ(*it, t * per_thread + i);
+      }
+    });
+  }
+  for (auto &w : writers) {
+    w.join();
+  }
+
+  ASSERT_EQ(v.size(), threads * per_thread);
+  std::vector<int> values(v.begin(), v.end());
+  std::sort(values.begin(), values.end());
+  for (int i = 0; i < threads * per_thread; ++i) {
+    ASSERT_EQ(values[i], i);
+  }
+}
+
+TEST(ConcurrentVectorTest, GrowByTest) {
+  concurrent_vector<std::string> v;
+  auto *first = &v.emplace_back("first")[0];
+
+  std::vector<std::thread> writers;
+  for (int t = 0; t < 4; ++t) {
+    writers.emplace_back([&v, t] {
+      for (int i = 0; i < 100; ++i) {
+        auto it = v.grow_by(37, std::to_string(t));
+        // a run is contiguous in index space
+        for (int j = 0; j < 37; ++j) {
+          EXPECT_EQ(it[j], std::to_string(t));
+        }
+      }
+    });
+  }
+  for (auto &w : writers) {
+    w.join();
+  }
+
+  EXPECT_EQ(v.size(), 1 + 4 * 100 * 37);
+  // elements never move
+  EXPECT_EQ(first, &v[0]);
+  EXPECT_EQ(v[0], "first");
+  EXPECT_GE(v.capacity(), v.size());
+  EXPECT_THROW(v.at(v.size()), std::out_of_range);
+
+  concurrent_vector<std::string> copy(v);
+  EXPECT_TRUE(std::equal(copy.begin(), copy.end(), v.begin(), v.end()));
+  auto moved = std::move(copy);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved.size(), v.size());
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  moved.grow_by(3);
+  EXPECT_EQ(moved[2], "");
+}
+
+TEST(ConcurrentVectorTest, ThrowingConstructorTest) {
+  struct fragile {
+    fragile() noexcept = default;
+    explicit fragile(int v) : value{v} {
+      if (v < 0)
+        throw std::runtime_error("negative");
+    }
+    int value = 0;
+  };
+
+  concurrent_vector<fragile> v;
+  v.emplace_back(1);
+  EXPECT_THROW(v.emplace_back(-1), std::runtime_error);
+  // the claimed slot holds a default object
+  EXPECT_EQ(v.size(), 2);
+  EXPECT_EQ(v[1].value, 0);
+  v.reserve(10'000);
+  EXPECT_GE(v.capacity(), 10'000);
+}
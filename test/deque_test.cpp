@@ -0,0 +1,167 @@
+#include "../my/deque.h"
+#include <deque>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace my;
+
+namespace {
+// counts the bytes live in one arena; allocators of different arenas are
+// unequal and don't propagate
+struct arena_stats {
+  std::ptrdiff_t live = 0;
+};
+
+template <class T> struct arena_allocator {
+  using value_type = T;
+  arena_stats *stats;
+
+  explicit arena_allocator(arena_stats *s) noexcept : stats{s} {}
+  template <class U>
+  arena_allocator(const arena_allocator<U> &other) noexcept
+      : stats{other.stats} {}
+
+  T *allocate(std::size_t n) {
+    stats->live += static_cast<std::ptrdiff_t>(n * sizeof(T));
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) noexcept {
+    stats->live -= static_cast<std::ptrdiff_t>(n * sizeof(T));
+    std::allocator<T>{}.deallocate(p, n);
+  }
+  friend bool operator==(const arena_allocator &a,
+                         const arena_allocator &b) noexcept {
+    return a.stats == b.stats;
+  }
+};
+} // namespace
+
+TEST(DequeTest, PushPopTest) {
+  deque<int> d;
+  std::deque<int> expected;
+  EXPECT_TRUE(d.empty());
+
+  for (int i = 0; i < 5000; ++i) {
+    if (i % 3 == 0) {
+      d.push_front(i);
+      expected.push_front(i);
+    } else {
+      d.push_back(i);
+      expected.push_back(i);
+    }
+  }
+  EXPECT_EQ(d.size(), expected.size());
+  EXPECT_TRUE(std::equal(d.begin(), d.end(), expected.begin(), expected.end()));
+  EXPECT_EQ(d.front(), expected.front());
+  EXPECT_EQ(d.back(), expected.back());
+  EXPECT_EQ(d[1234], expected[1234]);
+  EXPECT_THROW(d.at(5000), std::out_of_range);
+
+  // drain from both ends past block boundaries, then refill
+  for (int i = 0; i < 4990; ++i) {
+    if (i % 2 == 0) {
+      d.pop_front();
+      expected.pop_front();
+    } else {
+      d.pop_back();
+      expected.pop_back();
+    }
+  }
+  EXPECT_TRUE(std::equal(d.begin(), d.end(), expected.begin(), expected.end()));
+  while (!d.empty()) {
+    d.pop_back();
+  }
+  d.push_front(1);
+  d.push_back(2);
+  EXPECT_EQ(d, (deque<int>{1, 2}));
+
+  // queue usage: push back, pop front
+  deque<int> q;
+  for (int i = 0; i < 100'000; ++i) {
+    q.push_back(i);
+    if (i % 2 == 1) {
+      q.pop_front();
+    }
+  }
+  EXPECT_EQ(q.size(), 50'000);
+  EXPECT_EQ(q.front(), 50'000);
+  EXPECT_EQ(q.back(), 99'999);
+}
+
+TEST(DequeTest, StableReferencesTest) {
+  deque<std::string> d;
+  d.push_back("anchor");
+  auto *anchor = &d.front();
+
+  std::vector<const std::string *> addresses;
+  for (int i = 0; i < 20'000; ++i) {
+    addresses.push_back(&d.emplace_back(std::to_string(i)));
+    d.emplace_front("front");
+  }
+  EXPECT_EQ(anchor, &d[20'000]);
+  EXPECT_EQ(*anchor, "anchor");
+  for (int i = 0; i < 20'000; ++i) {
+    EXPECT_EQ(addresses[i], &d[20'001 + i]);
+  }
+}
+
+TEST(DequeTest, CopyMoveTest) {
+  deque<std::string> d(3, "x");
+  d.resize(5);
+  EXPECT_EQ(d.size(), 5);
+  EXPECT_EQ(d[4], "");
+
+  deque<std::string> copy(d);
+  EXPECT_EQ(copy, d);
+  copy.push_front("y");
+  EXPECT_NE(copy, d);
+  EXPECT_GT(copy, d);
+
+  deque<std::string> moved(std::move(copy));
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(moved.front(), "y");
+  copy = moved;
+  EXPECT_EQ(copy, moved);
+  moved = std::move(copy);
+  EXPECT_EQ(moved.size(), 6);
+
+  std::vector<std::string> reversed(moved.rbegin(), moved.rend());
+  EXPECT_EQ(reversed.back(), "y");
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+  moved.push_back("z");
+  EXPECT_EQ(moved.front(), "z");
+}
+
+TEST(DequeTest, StatefulAllocatorTest) {
+  using arena_deque = deque<int, arena_allocator<int>>;
+  arena_stats r1, r2;
+  {
+    arena_deque a{arena_allocator<int>(&r1)};
+    arena_deque b{arena_allocator<int>(&r2)};
+    for (int i = 0; i < 5000; ++i) {
+      a.push_back(i);
+    }
+    b.push_back(-1);
+
+    // each deque keeps its own allocator and its blocks come from it
+    b = a;
+    EXPECT_EQ(b, a);
+    EXPECT_EQ(b.get_allocator(), arena_allocator<int>(&r2));
+    b = std::move(a);
+    EXPECT_EQ(b.size(), 5000);
+    EXPECT_EQ(b[4999], 4999);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(b.get_allocator(), arena_allocator<int>(&r2));
+
+    // equal allocators hand the blocks over
+    arena_deque c{arena_allocator<int>(&r2)};
+    const int *front = &b.front();
+    c = std::move(b);
+    EXPECT_EQ(&c.front(), front);
+    a.push_back(1);
+  }
+  EXPECT_EQ(r1.live, 0);
+  EXPECT_EQ(r2.live, 0);
+}
@@ -0,0 +1,127 @@
+#include "../my/flat_map.h"
+#include "../my/flat_set.h"
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <random>
+#include <string>
+#include <vector>
+
+using namespace my;
+
+TEST(FlatSetTest, BulkAndBatchedInsertTest) {
+  flat_set<int> s(vector<int>{5, 1, 4, 1, 5, 9, 2, 6, 5, 3});
+  EXPECT_EQ(s.keys(), (vector<int>{1, 2, 3, 4, 5, 6, 9}));
+  EXPECT_TRUE(s.contains(9));
+  EXPECT_FALSE(s.contains(7));
+
+  EXPECT_FALSE(s.insert(4).second);
+  auto [it, inserted] = s.insert(7);
+  EXPECT_TRUE(inserted);
+  EXPECT_EQ(*it, 7);
+
+  std::vector<int> more{12, 0, 7, 8, 12, 10};
+  s.insert(more.begin(), more.end());
+  EXPECT_EQ(s.keys(),
+            (vector<int>{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 12}));
+
+  EXPECT_EQ(s.erase(3), 1);
+  EXPECT_EQ(s.erase(3), 0);
+  EXPECT_EQ(*s.upper_bound(10), 12);
+  EXPECT_EQ(s.lower_bound(11), s.find(12));
+  EXPECT_EQ(s.find(11), s.end());
+
+  flat_set<int> t{12, 10, 9, 8, 7, 6, 5, 4, 2, 1, 0};
+  EXPECT_EQ(s, t);
+}
+
+// the Eytzinger path must agree with std::lower_bound for every probe,
+// including ones below, between and above the keys
+TEST(FlatSetTest, ReadOptimizedTest) {
+  std::mt19937 gen(42);
+  for (std::size_t n : {0, 1, 2, 3, 7, 8, 15, 16, 17, 100, 1000, 4097}) {
+    vector<int> raw;
+    for (std::size_t i = 0; i < n; ++i) {
+      raw.push_back(static_cast<int>(gen() % (4 * n + 1)) * 2);
+    }
+    flat_set<int> s(raw);
+    s.optimize_for_reads();
+    ASSERT_TRUE(s.read_optimized());
+    const auto &keys = s.keys();
+    for (int x = -1; x <= static_cast<int>(8 * n + 3); ++x) {
+      auto expected = std::lower_bound(keys.begin(), keys.end(), x);
+      ASSERT_EQ(s.lower_bound(x), expected) << "n=" << n << " x=" << x;
+      ASSERT_EQ(s.contains(x), expected != keys.end() && *expected == x);
+    }
+  }
+
+  flat_set<int> s{3, 1, 2};
+  s.optimize_for_reads();
+  s.insert(0);
+  EXPECT_FALSE(s.read_optimized());
+  EXPECT_TRUE(s.contains(0));
+}
+
+TEST(FlatMapTest, BulkConstructionTest) {
+  // the first value of a repeated key wins, as with repeated insert()
+  flat_map<int, std::string> m(vector<int>{3, 1, 3, 2, 1},
+                               vector<std::string>{"c", "a", "x", "b", "y"});
+  EXPECT_EQ(m.keys(), (vector<int>{1, 2, 3}));
+  EXPECT_EQ(m.values(), (vector<std::string>{"a", "b", "c"}));
+  EXPECT_THROW((flat_map<int, int>(vector<int>{1, 2}, vector<int>{1})),
+               std::invalid_argument);
+
+  flat_map<std::string, int> n{{"b", 2}, {"a", 1}, {"c", 3}, {"a", 9}};
+  EXPECT_EQ(n.size(), 3);
+  EXPECT_EQ(n.at("a"), 1);
+  EXPECT_THROW(n.at("z"), std::out_of_range);
+
+  std::vector<std::pair<std::string, int>> sorted{{"a", 1}, {"b", 2}};
+  flat_map<std::string, int> copy(sorted.begin(), sorted.end());
+  std::vector<std::pair<std::string, int>> back;
+  for (auto [k, v] : copy) {
+    back.emplace_back(k, v);
+  }
+  EXPECT_EQ(back, sorted);
+}
+
+TEST(FlatMapTest, ModifiersTest) {
+  flat_map<int, int> m;
+  m[5] = 50;
+  m[1] = 10;
+  ++m[5];
+  EXPECT_EQ(m.size(), 2);
+  EXPECT_EQ(m[5], 51);
+
+  EXPECT_FALSE(m.try_emplace(1, 99).second);
+  EXPECT_EQ(m.at(1), 10);
+  EXPECT_FALSE(m.insert_or_assign(1, 11).second);
+  EXPECT_EQ(m.at(1), 11);
+  EXPECT_TRUE(m.insert({3, 30}).second);
+
+  std::vector<std::pair<int, int>> run{{4, 40}, {2, 20}, {3, 0}, {6, 60}};
+  m.insert(run.begin(), run.end());
+  EXPECT_EQ(m.keys(), (vector<int>{1, 2, 3, 4, 5, 6}));
+  EXPECT_EQ(m.values(), (vector<int>{11, 20, 30, 40, 51, 60}));
+
+  m.optimize_for_reads();
+  EXPECT_EQ(m.find(4)->second, 40);
+  m.find(4)->second = 41;
+  EXPECT_TRUE(m.read_optimized());
+  EXPECT_EQ(m.lower_bound(7), m.end());
+  auto [first, last] = m.equal_range(2);
+  EXPECT_EQ(last - first, 1);
+  EXPECT_EQ((*first).second, 20);
+
+  auto it = m.erase(m.find(2));
+  EXPECT_FALSE(m.read_optimized());
+  EXPECT_EQ(it->first, 3);
+  EXPECT_EQ(m.erase(6), 1);
+  EXPECT_EQ(m, (flat_map<int, int>{{1, 11}, {3, 30}, {4, 41}, {5, 51}}));
+  EXPECT_LT(m, (flat_map<int, int>{{1, 11}, {3, 31}}));
+
+  std::size_t n = 0;
+  for (auto rit = m.rbegin(); rit != m.rend(); ++rit) {
+    ++n;
+  }
+  EXPECT_EQ(n, m.size());
+}
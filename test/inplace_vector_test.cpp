@@ -0,0 +1,82 @@
+#include "../my/inplace_vector.h"
+#include <gtest/gtest.h>
+#include <ranges>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+using namespace my;
+
+static_assert(std::is_trivially_copyable_v<inplace_vector<int, 8>>);
+static_assert(!std::is_trivially_copyable_v<inplace_vector<std::string, 8>>);
+static_assert(sizeof(inplace_vector<std::uint32_t, 15>) == 64);
+
+TEST(InplaceVectorTest, CapacityTest) {
+  inplace_vector<int, 4> v{1, 2, 3};
+  EXPECT_EQ(v.capacity(), 4);
+  EXPECT_EQ(v.size(), 3);
+
+  v.push_back(4);
+  EXPECT_THROW(v.push_back(5), std::bad_alloc);
+  EXPECT_THROW(v.insert(v.begin(), 0), std::bad_alloc);
+  EXPECT_THROW(v.resize(5), std::bad_alloc);
+  EXPECT_THROW((inplace_vector<int, 4>(5, 0)), std::bad_alloc);
+  EXPECT_EQ(v.try_push_back(5), nullptr);
+  EXPECT_EQ(v.try_emplace_back(5), nullptr);
+  EXPECT_EQ(v, (inplace_vector<int, 4>{1, 2, 3, 4}));
+
+  v.pop_back();
+  auto *p = v.try_emplace_back(9);
+  ASSERT_NE(p, nullptr);
+  EXPECT_EQ(*p, 9);
+  EXPECT_EQ(p, &v.back());
+
+  // trivially copyable: copies are plain byte copies of the object
+  auto copy = v;
+  v.clear();
+  EXPECT_EQ(copy.size(), 4);
+  EXPECT_EQ(copy[3], 9);
+
+  std::vector<int> src{10, 11, 12, 13, 14};
+  inplace_vector<int, 4> partial{1};
+  auto rest = partial.try_append_range(src);
+  EXPECT_EQ(partial, (inplace_vector<int, 4>{1, 10, 11, 12}));
+  EXPECT_EQ(*rest, 13);
+}
+
+TEST(InplaceVectorTest, ModifiersTest) {
+  inplace_vector<std::string, 8> v{"b", "e"};
+  v.insert(v.begin(), "a");
+  v.insert(v.begin() + 2, {"c", "d"});
+  v.emplace(v.end(), 2, 'f');
+  v.insert(v.begin(), std::size_t{2}, "z");
+  EXPECT_EQ(v, (inplace_vector<std::string, 8>{"z", "z", "a", "b", "c", "d",
+                                               "e", "ff"}));
+  EXPECT_THROW(v.emplace_back("g"), std::bad_alloc);
+
+  v.erase(v.begin(), v.begin() + 2);
+  v.erase(v.begin() + 1);
+  EXPECT_EQ(v.size(), 5);
+  EXPECT_EQ(v.front(), "a");
+  EXPECT_EQ(v.at(1), "c");
+  EXPECT_THROW((void)v.at(5), std::out_of_range);
+
+  auto copy = v;
+  inplace_vector<std::string, 8> other{"x"};
+  other = std::move(copy);
+  EXPECT_EQ(other, v);
+  other.resize(2);
+  v.swap(other);
+  EXPECT_EQ(v.size(), 2);
+  EXPECT_EQ(other.size(), 5);
+  EXPECT_EQ(other.back(), "ff");
+  EXPECT_LT(v, other);
+
+  auto squares = inplace_vector<int, 16>(
+      std::from_range,
+      std::views::iota(0, 10) | std::views::transform([](int i) {
+        return i * i;
+      }));
+  EXPECT_EQ(squares.size(), 10);
+  EXPECT_EQ(squares[9], 81);
+}
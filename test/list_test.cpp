@@ -0,0 +1,126 @@
+#include "../my/list.h"
+#include "../my/pool_allocator.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace my;
+
+namespace {
+template <class T, class A> std::vector<T> to_std(const list<T, A> &l) {
+  return std::vector<T>(l.begin(), l.end());
+}
+} // namespace
+
+TEST(ListTest, ModifiersTest) {
+  list<std::string> l;
+  l.push_back("b");
+  l.emplace_back(2, 'c');
+  l.push_front("a");
+  auto it = l.emplace(std::next(l.begin(), 2), "x");
+  EXPECT_EQ(*it, "x");
+  EXPECT_EQ(l.size(), 4);
+  EXPECT_EQ(to_std(l), (std::vector<std::string>{"a", "b", "x", "cc"}));
+  EXPECT_EQ(l.front(), "a");
+  EXPECT_EQ(l.back(), "cc");
+
+  it = l.erase(it);
+  EXPECT_EQ(*it, "cc");
+  l.pop_front();
+  l.pop_back();
+  EXPECT_EQ(to_std(l), (std::vector<std::string>{"b"}));
+
+  l.insert(l.end(), {"d"});
+  l.insert(l.begin(), std::string("z"));
+  it = l.erase(l.begin(), std::next(l.begin(), 2));
+  EXPECT_EQ(*it, "d");
+  EXPECT_EQ(l.size(), 1);
+  l.clear();
+  EXPECT_TRUE(l.empty());
+  EXPECT_EQ(l.begin(), l.end());
+}
+
+TEST(ListTest, AssignmentTest) {
+  list<int> a(3, 7);
+  list<int> b;
+  b.push_back(1);
+  b = a;
+  EXPECT_EQ(to_std(b), (std::vector<int>{7, 7, 7}));
+  a.push_back(8);
+  EXPECT_EQ(b.size(), 3);
+
+  list<int> c;
+  c = std::move(a);
+  EXPECT_EQ(to_std(c), (std::vector<int>{7, 7, 7, 8}));
+  c.swap(b);
+  EXPECT_EQ(c.size(), 3);
+  EXPECT_EQ(b.back(), 8);
+
+  // moved-from lists are empty and stay usable
+  EXPECT_TRUE(a.empty());
+  EXPECT_EQ(a.begin(), a.end());
+  a.push_back(3);
+  a.push_front(2);
+  EXPECT_EQ(to_std(a), (std::vector<int>{2, 3}));
+  list<int> d(std::move(a));
+  EXPECT_TRUE(a.empty());
+  a.push_back(4);
+  EXPECT_EQ(a.back(), 4);
+  EXPECT_EQ(to_std(d), (std::vector<int>{2, 3}));
+}
+
+TEST(ListTest, PoolAllocatorTest) {
+  // a node type of its own, so that this test owns the pool behind it
+  struct job {
+    long id;
+    char payload[40];
+  };
+  using pooled = list<job, pool_allocator<job>>;
+  using node_allocator = pool_allocator<detail::list_node<job>>;
+  auto id = [](long i) { return job{i, {}}; };
+
+  pooled l;
+  for (long i = 0; i < 5000; ++i) {
+    l.push_back(id(i));
+  }
+  // nodes are carved from 64 KiB slabs, one after the other
+  auto slabs = node_allocator::slab_count();
+  EXPECT_GE(slabs, 1);
+  EXPECT_LE(slabs, 5);
+  auto first = reinterpret_cast<std::uintptr_t>(&l.front());
+  auto second = reinterpret_cast<std::uintptr_t>(&*std::next(l.begin()));
+  EXPECT_EQ(second - first, sizeof(detail::list_node<job>));
+
+  // freed nodes are reused rather than taken from new slabs
+  for (int round = 0; round < 10; ++round) {
+    for (int i = 0; i < 1000; ++i) {
+      l.pop_front();
+    }
+    for (long i = 0; i < 1000; ++i) {
+      l.push_back(id(i));
+    }
+  }
+  EXPECT_EQ(node_allocator::slab_count(), slabs);
+
+  pooled copy(l);
+  pooled moved(std::move(copy));
+  EXPECT_EQ(moved.size(), 5000);
+  EXPECT_EQ(moved.front().id, l.front().id);
+
+  // nodes allocated on one thread and freed on another
+  std::thread consumer([&l] {
+    while (!l.empty()) {
+      l.pop_front();
+    }
+  });
+  consumer.join();
+  EXPECT_TRUE(l.empty());
+
+  std::vector<int> src{1, 2, 3};
+  list<int, pool_allocator<int, false>> unlocked(src.begin(), src.end());
+  unlocked.erase(std::next(unlocked.begin()));
+  EXPECT_EQ(to_std(unlocked), (std::vector<int>{1, 3}));
+}
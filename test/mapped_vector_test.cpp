@@ -0,0 +1,120 @@
+#include "../my/mapped_vector.h"
+#include <filesystem>
+#include <fstream>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <string>
+#include <unistd.h>
+
+using namespace my;
+
+namespace {
+struct record {
+  std::uint64_t id;
+  double price;
+  std::int32_t qty;
+};
+
+// removes the file when the test ends
+struct temp_file {
+  std::filesystem::path path;
+
+  explicit temp_file(const std::string &name)
+      : path{std::filesystem::temp_directory_path() /
+             (name + "." + std::to_string(::getpid()))} {
+    std::filesystem::remove(path);
+  }
+  ~temp_file() { std::filesystem::remove(path); }
+};
+} // namespace
+
+TEST(MappedVectorTest, PersistTest) {
+  temp_file file("mapped_vector_persist");
+  {
+    mapped_vector<record> v(file.path, mapped_mode::create);
+    EXPECT_TRUE(v.is_open());
+    EXPECT_TRUE(v.empty());
+    for (std::uint64_t i = 0; i < 1000; ++i) {
+      v.push_back({i, i * 0.25, static_cast<std::int32_t>(i % 7)});
+    }
+    EXPECT_EQ(v.size(), 1000);
+    EXPECT_EQ(v.back().id, 999);
+    v.flush();
+  }
+
+  // zero-copy reload: data() points into the mapping
+  mapped_vector<record> ro(file.path);
+  EXPECT_EQ(ro.mode(), mapped_mode::read_only);
+  ASSERT_EQ(ro.size(), 1000);
+  EXPECT_DOUBLE_EQ(ro[10].price, 2.5);
+  EXPECT_EQ(ro.end() - ro.begin(), 1000);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ro.data()) % alignof(record), 0);
+  EXPECT_THROW(ro.push_back({}), std::logic_error);
+  EXPECT_THROW(ro.at(1000), std::out_of_range);
+
+  // a second writer appends, the existing reader mapping is unaffected
+  {
+    mapped_vector<record> rw(file.path, mapped_mode::read_write);
+    EXPECT_EQ(rw.size(), 1000);
+    rw[0].qty = 42;
+    rw.resize(5000, record{7, 0.0, 1});
+    EXPECT_EQ(rw[4999].id, 7);
+  }
+  EXPECT_EQ(ro[0].qty, 42); // shared mapping
+  mapped_vector<record> reopened(file.path);
+  EXPECT_EQ(reopened.size(), 5000);
+}
+
+TEST(MappedVectorTest, GrowthTest) {
+  temp_file file("mapped_vector_growth");
+  mapped_vector<std::uint32_t> v(file.path, mapped_mode::create);
+  v.resize(3'000'000);
+  std::iota(v.begin(), v.end(), 0u);
+  for (std::uint32_t i = 0; i < 1000; ++i) {
+    v.emplace_back(v[i]); // argument aliases the mapping
+  }
+  EXPECT_EQ(v.size(), 3'001'000);
+  EXPECT_EQ(v.back(), 999);
+  EXPECT_GE(v.capacity(), v.size());
+  EXPECT_GE(std::filesystem::file_size(file.path),
+            64 + v.size() * sizeof(std::uint32_t));
+
+  v.resize(10);
+  v.shrink_to_fit();
+  EXPECT_EQ(std::filesystem::file_size(file.path),
+            static_cast<std::uintmax_t>(::sysconf(_SC_PAGESIZE)));
+  EXPECT_EQ(v[9], 9);
+
+  mapped_vector<std::uint32_t> moved(std::move(v));
+  EXPECT_FALSE(v.is_open());
+  EXPECT_EQ(moved.size(), 10);
+  moved.clear();
+  EXPECT_TRUE(moved.empty());
+}
+
+TEST(MappedVectorTest, HeaderCheckTest) {
+  temp_file file("mapped_vector_header");
+  {
+    mapped_vector<std::uint32_t> v(file.path, mapped_mode::create);
+    v.push_back(1);
+  }
+  EXPECT_THROW(mapped_vector<std::uint64_t>{file.path}, std::runtime_error);
+  EXPECT_NO_THROW(mapped_vector<std::uint32_t>{file.path});
+
+  // a size whose byte count wraps around must not pass as fitting the file
+  {
+    std::fstream f(file.path,
+                   std::ios::in | std::ios::out | std::ios::binary);
+    std::uint64_t huge = (std::uint64_t{1} << 62) + 1;
+    f.seekp(offsetof(detail::mapped_header, size));
+    f.write(reinterpret_cast<const char *>(&huge), sizeof huge);
+  }
+  EXPECT_THROW(mapped_vector<std::uint32_t>{file.path}, std::runtime_error);
+
+  temp_file junk("mapped_vector_junk");
+  std::ofstream(junk.path) << std::string(100, 'x');
+  EXPECT_THROW(mapped_vector<std::uint32_t>{junk.path}, std::runtime_error);
+
+  temp_file missing("mapped_vector_missing");
+  EXPECT_THROW(mapped_vector<std::uint32_t>{missing.path}, std::system_error);
+}
@@ -0,0 +1,204 @@
+#include "../my/list.h"
+#include "../my/memory.h"
+#include "../my/memory_resource.h"
+#include "../my/vector.h"
+#include <gtest/gtest.h>
+#include <cstdint>
+#include <string>
+
+using namespace my;
+
+namespace {
+// upstream that forwards to new/delete and counts what passes through it
+class counting_resource : public memory_resource {
+public:
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+  std::size_t live_bytes = 0;
+
+private:
+  void *do_allocate(std::size_t bytes, std::size_t alignment) override {
+    ++allocations;
+    live_bytes += bytes;
+    return new_delete_resource()->allocate(bytes, alignment);
+  }
+  void do_deallocate(void *p, std::size_t bytes,
+                     std::size_t alignment) override {
+    ++deallocations;
+    live_bytes -= bytes;
+    new_delete_resource()->deallocate(p, bytes, alignment);
+  }
+  bool do_is_equal(const memory_resource &other) const noexcept override {
+    return this == &other;
+  }
+};
+
+template <class T> using pmr_vector = vector<T, polymorphic_allocator<T>>;
+template <class T> using pmr_list = list<T, polymorphic_allocator<T>>;
+} // namespace
+
+TEST(MemoryResourceTest, MonotonicArenaTest) {
+  counting_resource upstream;
+  {
+    monotonic_buffer_resource arena(&upstream);
+    {
+      pmr_vector<int> v(&arena);
+      pmr_list<std::string> l(&arena);
+      for (int i = 0; i < 1000; ++i) {
+        v.push_back(i);
+        l.push_back(std::to_string(i));
+      }
+      l.pop_front();
+      v.clear();
+      v.shrink_to_fit();
+      EXPECT_EQ(l.size(), 999);
+      EXPECT_EQ(l.front(), "1");
+    }
+
+    // buffers double, so a thousand nodes and a vector's regrowth take a
+    // handful of upstream calls, and nothing is given back early
+    EXPECT_GT(upstream.allocations, 0);
+    EXPECT_LT(upstream.allocations, 20);
+    EXPECT_EQ(upstream.deallocations, 0);
+
+    // a released arena starts over from its first buffer size
+    arena.release();
+    EXPECT_EQ(upstream.live_bytes, 0);
+    auto *p = arena.allocate(10, 64);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % 64, 0);
+  }
+  EXPECT_EQ(upstream.allocations, upstream.deallocations);
+  EXPECT_EQ(upstream.live_bytes, 0);
+
+  // with an initial buffer and a null upstream the arena is a fixed budget
+  alignas(std::max_align_t) std::byte buffer[256];
+  monotonic_buffer_resource fixed(buffer, sizeof buffer,
+                                  null_memory_resource());
+  EXPECT_EQ(fixed.allocate(100), static_cast<void *>(buffer));
+  EXPECT_NE(fixed.allocate(100), nullptr);
+  EXPECT_THROW((void)fixed.allocate(100), std::bad_alloc);
+}
+
+TEST(MemoryResourceTest, PoolResourceTest) {
+  counting_resource upstream;
+  {
+    unsynchronized_pool_resource pool(
+        pool_options{.max_blocks_per_chunk = 64,
+                     .largest_required_pool_block = 256},
+        &upstream);
+    EXPECT_EQ(pool.options().largest_required_pool_block, 256);
+
+    // freed blocks are handed out again before the pool grows
+    void *a = pool.allocate(24);
+    pool.deallocate(a, 24);
+    EXPECT_EQ(pool.allocate(24), a);
+    auto chunks = upstream.allocations;
+    for (int i = 0; i < 100; ++i) {
+      void *p = pool.allocate(48);
+      pool.deallocate(p, 48);
+    }
+    EXPECT_LE(upstream.allocations, chunks + 1);
+
+    // blocks are aligned to their size class
+    for (std::size_t align : {8, 16, 32, 64, 128}) {
+      auto *p = pool.allocate(align, align);
+      EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) % align, 0);
+    }
+
+    // anything larger than the largest pool goes to upstream and back
+    auto before = upstream.live_bytes;
+    void *big = pool.allocate(5000, 256);
+    EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big) % 256, 0);
+    EXPECT_GT(upstream.live_bytes, before + 5000);
+    pool.deallocate(big, 5000, 256);
+    EXPECT_EQ(upstream.live_bytes, before);
+
+    {
+      pmr_list<int> l(&pool);
+      for (int i = 0; i < 500; ++i)
+        l.push_back(i);
+    }
+    // release() hands back what is still out, pooled or large
+    EXPECT_NE(pool.allocate(40), nullptr);
+    EXPECT_NE(pool.allocate(9000), nullptr);
+    pool.release();
+    EXPECT_EQ(upstream.live_bytes, 0);
+    // and the pool starts over afterwards
+    EXPECT_NE(pool.allocate(24), nullptr);
+  }
+  EXPECT_EQ(upstream.allocations, upstream.deallocations);
+}
+
+TEST(MemoryResourceTest, PolymorphicAllocatorTest) {
+  counting_resource a_upstream;
+  counting_resource b_upstream;
+  monotonic_buffer_resource a(&a_upstream);
+  unsynchronized_pool_resource b(&b_upstream);
+
+  // copies go to the default resource, not the source's
+  pmr_vector<std::string> va({"x", "y", "z"}, &a);
+  pmr_vector<std::string> copy(va);
+  EXPECT_EQ(copy.get_allocator().resource(), get_default_resource());
+  pmr_vector<std::string> copy_b(va, &b);
+  EXPECT_EQ(copy_b.get_allocator().resource(), &b);
+
+  // assignment copies the elements into the target's own resource
+  pmr_vector<std::string> vb({"w"}, &b);
+  vb = va;
+  EXPECT_EQ(vb, va);
+  EXPECT_EQ(vb.get_allocator().resource(), &b);
+  vb = std::move(va);
+  EXPECT_EQ(vb.get_allocator().resource(), &b);
+  EXPECT_EQ(vb.size(), 3);
+  vb = {"u", "v"};
+  EXPECT_EQ(vb.get_allocator().resource(), &b);
+
+  pmr_list<int> la(&a);
+  pmr_list<int> lb(&b);
+  for (int i = 0; i < 10; ++i)
+    la.push_back(i);
+  lb = la;
+  EXPECT_EQ(lb.get_allocator().resource(), &b);
+  EXPECT_EQ(lb.size(), 10);
+  pmr_list<int> lc(&b);
+  lc = std::move(la);
+  EXPECT_EQ(lc.get_allocator().resource(), &b);
+  EXPECT_EQ(lc.size(), 10);
+  EXPECT_EQ(lc.back(), 9);
+  lc = std::move(lb);
+  EXPECT_EQ(lc.size(), 10);
+
+  // set_default_resource redirects default-constructed allocators
+  auto *old = set_default_resource(&a);
+  EXPECT_EQ(old, new_delete_resource());
+  EXPECT_EQ(polymorphic_allocator<int>().resource(), &a);
+  EXPECT_EQ(set_default_resource(nullptr), &a);
+  EXPECT_EQ(get_default_resource(), new_delete_resource());
+
+  EXPECT_EQ(polymorphic_allocator<int>(&a), polymorphic_allocator<char>(&a));
+  EXPECT_NE(polymorphic_allocator<int>(&a), polymorphic_allocator<int>(&b));
+}
+
+TEST(MemoryResourceTest, AllocateUniqueTest) {
+  counting_resource upstream;
+  unsynchronized_pool_resource pool(&upstream);
+  polymorphic_allocator<> alloc(&pool);
+  {
+    auto p = allocate_unique<std::string>(alloc, 40, 'x');
+    EXPECT_EQ(p->size(), 40);
+    auto q = std::move(p);
+    EXPECT_FALSE(p);
+    EXPECT_EQ(q.get_deleter().alloc.resource(), &pool);
+
+    // the freed block is the next one handed out
+    std::string *addr = q.get();
+    q.reset();
+    auto r = allocate_unique<std::string>(alloc, "y");
+    EXPECT_EQ(r.get(), addr);
+  }
+  auto *n = alloc.new_object<pmr_vector<int>>(std::size_t{3}, 7);
+  EXPECT_EQ((*n)[2], 7);
+  alloc.delete_object(n);
+  pool.release();
+  EXPECT_EQ(upstream.live_bytes, 0);
+}
@@ -0,0 +1,129 @@
+#include "../my/persistent_vector.h"
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace my;
+
+namespace {
+template <class T>
+void expect_same(const persistent_vector<T> &pv, const std::vector<T> &ref) {
+  ASSERT_EQ(pv.size(), ref.size());
+  for (std::size_t i = 0; i < ref.size(); ++i) {
+    ASSERT_EQ(pv[i], ref[i]) << "at " << i;
+  }
+  EXPECT_TRUE(std::equal(pv.begin(), pv.end(), ref.begin(), ref.end()));
+}
+} // namespace
+
+TEST(PersistentVectorTest, VersionsTest) {
+  persistent_vector<std::string> empty;
+  auto one = empty.push_back("a");
+  auto two = one.push_back("b");
+  EXPECT_TRUE(empty.empty());
+  EXPECT_EQ(one.size(), 1);
+  EXPECT_EQ(two, (persistent_vector<std::string>{"a", "b"}));
+
+  // every version stays as it was, across several tree levels
+  std::vector<persistent_vector<int>> versions{persistent_vector<int>{}};
+  for (int i = 0; i < 40000; ++i) {
+    versions.push_back(versions.back().push_back(i));
+  }
+  for (std::size_t n : {0, 1, 32, 33, 1024, 1025, 32768, 32769, 40000}) {
+    ASSERT_EQ(versions[n].size(), n);
+    if (n != 0) {
+      EXPECT_EQ(versions[n].back(), static_cast<int>(n) - 1);
+    }
+  }
+
+  auto &full = versions.back();
+  auto changed = full.set(1234, -1).set(39999, -2);
+  EXPECT_EQ(full[1234], 1234);
+  EXPECT_EQ(changed[1234], -1);
+  EXPECT_EQ(changed[39999], -2);
+  EXPECT_EQ(changed.pop_back().size(), 39999);
+  EXPECT_THROW((void)full.at(40000), std::out_of_range);
+  EXPECT_THROW((void)full.set(40000, 0), std::out_of_range);
+  EXPECT_LT(changed, full);
+}
+
+// random concatenations and slices against std::vector
+TEST(PersistentVectorTest, ConcatSliceTest) {
+  std::mt19937 gen(7);
+  std::vector<persistent_vector<std::string>> pool;
+  std::vector<std::vector<std::string>> refs;
+  for (int i = 0; i < 8; ++i) {
+    persistent_vector<std::string> pv;
+    std::vector<std::string> ref;
+    auto n = gen() % 3000;
+    for (std::size_t j = 0; j < n; ++j) {
+      auto s = std::to_string(i) + "/" + std::to_string(j);
+      pv = pv.push_back(s);
+      ref.push_back(s);
+    }
+    pool.push_back(pv);
+    refs.push_back(ref);
+  }
+
+  for (int round = 0; round < 300; ++round) {
+    auto a = gen() % pool.size();
+    auto b = gen() % pool.size();
+    auto pv = pool[a] + pool[b];
+    auto ref = refs[a];
+    ref.insert(ref.end(), refs[b].begin(), refs[b].end());
+
+    auto last = ref.empty() ? 0 : gen() % (ref.size() + 1);
+    auto first = last == 0 ? 0 : gen() % (last + 1);
+    pv = pv.slice(first, last);
+    ref = std::vector<std::string>(ref.begin() + first, ref.begin() + last);
+    pv = pv.push_back("x");
+    ref.push_back("x");
+    ASSERT_NO_FATAL_FAILURE(expect_same(pv, ref));
+
+    // keep the pool from growing without bound
+    auto slot = gen() % pool.size();
+    if (ref.size() < 200000) {
+      pool[slot] = pv;
+      refs[slot] = ref;
+    }
+  }
+  for (std::size_t i = 0; i < pool.size(); ++i) {
+    ASSERT_NO_FATAL_FAILURE(expect_same(pool[i], refs[i]));
+  }
+  EXPECT_THROW((void)pool[0].slice(1, 0), std::out_of_range);
+}
+
+TEST(PersistentVectorTest, TransientTest) {
+  auto t = persistent_vector<std::string>{}.transient();
+  for (int i = 0; i < 5000; ++i) {
+    t.push_back(std::to_string(i));
+  }
+  auto snapshot = t.persistent();
+  t.set(0, "changed");
+  t.pop_back();
+  t.append(snapshot);
+  EXPECT_EQ(snapshot[0], "0");
+  EXPECT_EQ(snapshot.size(), 5000);
+  EXPECT_EQ(t.size(), 9999);
+  EXPECT_EQ(t[0], "changed");
+  EXPECT_EQ(t[4999], "0");
+
+  // versions made and dropped on other threads while readers walk them
+  auto base = t.persistent();
+  std::vector<std::thread> threads;
+  for (int k = 0; k < 4; ++k) {
+    threads.emplace_back([base, k] {
+      auto v = base;
+      for (int i = 0; i < 1000; ++i) {
+        v = v.set(static_cast<std::size_t>(i * 7 + k), std::to_string(k));
+      }
+      EXPECT_EQ(v[7 + k], std::to_string(k));
+    });
+  }
+  for (auto &th : threads) {
+    th.join();
+  }
+  EXPECT_EQ(base[7], "7");
+}
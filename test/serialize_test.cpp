@@ -0,0 +1,116 @@
+#include "../my/serialize.h"
+#include <fcntl.h>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <unistd.h>
+
+using namespace my;
+
+namespace {
+struct employee {
+  std::string name;
+  vector<int> reports;
+
+  bool operator==(const employee &) const = default;
+};
+
+// scratch file, rewound between writing and reading
+struct temp_fd {
+  std::filesystem::path path;
+  int fd;
+
+  explicit temp_fd(const std::string &name)
+      : path{std::filesystem::temp_directory_path() /
+             (name + "." + std::to_string(::getpid()))},
+        fd{::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)} {}
+  ~temp_fd() {
+    ::close(fd);
+    std::filesystem::remove(path);
+  }
+
+  void rewind() const { ::lseek(fd, 0, SEEK_SET); }
+  off_t bytes() const { return ::lseek(fd, 0, SEEK_END); }
+};
+} // namespace
+
+template <> struct my::serializer<employee> {
+  static void write(binary_writer &w, const employee &e) {
+    w.write(e.name);
+    w.write(e.reports);
+  }
+  static void read(binary_reader &r, employee &e) {
+    r.read(e.name);
+    r.read(e.reports);
+  }
+};
+
+TEST(SerializeTest, TriviallyCopyableTest) {
+  temp_fd file("serialize_trivial");
+  ASSERT_GE(file.fd, 0);
+
+  vector<int> a(100000);
+  for (int i = 0; i < 100000; ++i) {
+    a[i] = i * 3;
+  }
+  vector<double> b{1.5, 2.5, 3.5};
+  vector<bool> bits(1000);
+  for (std::size_t i = 0; i < bits.size(); i += 7) {
+    bits[i] = true;
+  }
+  serialize(file.fd, a, b, bits);
+  EXPECT_EQ(file.bytes(), 3 * 8 + 100000 * 4 + 3 * 8 + 16 * 8);
+
+  file.rewind();
+  vector<int> a2{1, 2, 3};
+  vector<double> b2;
+  vector<bool> bits2;
+  deserialize(file.fd, a2, b2, bits2);
+  EXPECT_EQ(a2, a);
+  // one reservation for the whole payload: the allocator may round it up
+  // by malloc's slack, but not by a growth step
+  EXPECT_GE(a2.capacity(), a.size());
+  EXPECT_LT(a2.capacity(), a.size() + a.size() / 2);
+  EXPECT_EQ(b2, b);
+  EXPECT_EQ(bits2, bits);
+  EXPECT_EQ(bits2.count(), bits.count());
+}
+
+TEST(SerializeTest, CustomizationPointTest) {
+  temp_fd file("serialize_custom");
+  ASSERT_GE(file.fd, 0);
+
+  vector<employee> staff;
+  for (int i = 0; i < 5000; ++i) {
+    staff.push_back({"employee number " + std::to_string(i),
+                     vector<int>(static_cast<std::size_t>(i % 5), i)});
+  }
+  list<std::string> names;
+  for (int i = 0; i < 3000; ++i) {
+    names.push_back(std::string(i % 40, 'a' + i % 26));
+  }
+  list<long> ids(2500, 42L);
+  {
+    // small buffer so the elements stream through it in many chunks
+    binary_writer w(file.fd, 256);
+    w.write(staff);
+    w.write(names);
+    w.write(ids);
+    w.flush();
+  }
+
+  file.rewind();
+  vector<employee> staff2;
+  list<std::string> names2;
+  list<long> ids2;
+  binary_reader r(file.fd, 256);
+  r.read(staff2);
+  r.read(names2);
+  r.read(ids2);
+  EXPECT_EQ(staff2, staff);
+  ASSERT_EQ(names2.size(), names.size());
+  EXPECT_TRUE(std::equal(names2.begin(), names2.end(), names.begin()));
+  ASSERT_EQ(ids2.size(), ids.size());
+  EXPECT_TRUE(std::equal(ids2.begin(), ids2.end(), ids.begin()));
+  EXPECT_THROW(r.read<std::uint64_t>(), std::runtime_error);
+}
@@ -0,0 +1,160 @@
+#include "../my/small_vector.h"
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+using namespace my;
+
+namespace {
+// counts the bytes live in one arena; allocators of different arenas are
+// unequal and don't propagate
+struct arena_stats {
+  std::ptrdiff_t live = 0;
+};
+
+template <class T> struct arena_allocator {
+  using value_type = T;
+  arena_stats *stats;
+
+  explicit arena_allocator(arena_stats *s) noexcept : stats{s} {}
+  template <class U>
+  arena_allocator(const arena_allocator<U> &other) noexcept
+      : stats{other.stats} {}
+
+  T *allocate(std::size_t n) {
+    stats->live += static_cast<std::ptrdiff_t>(n * sizeof(T));
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) noexcept {
+    stats->live -= static_cast<std::ptrdiff_t>(n * sizeof(T));
+    std::allocator<T>{}.deallocate(p, n);
+  }
+  friend bool operator==(const arena_allocator &a,
+                         const arena_allocator &b) noexcept {
+    return a.stats == b.stats;
+  }
+};
+} // namespace
+
+TEST(SmallVectorTest, InlineStorageTest) {
+  small_vector<int, 4> v;
+  EXPECT_TRUE(v.empty());
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.capacity(), 4);
+
+  for (int i = 0; i < 4; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v.size(), 4);
+
+  // spill to the heap
+  v.push_back(4);
+  EXPECT_FALSE(v.is_inline());
+  EXPECT_GE(v.capacity(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(v[i], i);
+  }
+
+  // come back inline
+  v.erase(v.begin() + 1, v.end() - 1);
+  v.shrink_to_fit();
+  EXPECT_TRUE(v.is_inline());
+  EXPECT_EQ(v, (small_vector<int, 4>{0, 4}));
+}
+
+TEST(SmallVectorTest, ConstructorTest) {
+  small_vector<std::string, 2> v1(3, "hi");
+  EXPECT_EQ(v1.size(), 3);
+  EXPECT_EQ(v1[2], "hi");
+
+  std::vector<std::string> src{"alpha", "beta"};
+  small_vector<std::string, 2> v2(src.begin(), src.end());
+  EXPECT_TRUE(v2.is_inline());
+  EXPECT_EQ(v2[1], "beta");
+
+  auto v3 = small_vector<int, 8>(std::from_range, std::views::iota(0, 10));
+  EXPECT_EQ(v3.size(), 10);
+  EXPECT_EQ(v3.back(), 9);
+}
+
+TEST(SmallVectorTest, CopyMoveTest) {
+  small_vector<std::string, 3> inline_v{"a", "b"};
+  small_vector<std::string, 3> heap_v{"c", "d", "e", "f"};
+
+  auto copied = heap_v;
+  EXPECT_EQ(copied, heap_v);
+
+  small_vector<std::string, 3> moved_inline(std::move(inline_v));
+  EXPECT_TRUE(moved_inline.is_inline());
+  EXPECT_EQ(moved_inline[1], "b");
+  EXPECT_TRUE(inline_v.empty());
+
+  auto heap_data = heap_v.data();
+  small_vector<std::string, 3> moved_heap(std::move(heap_v));
+  EXPECT_EQ(moved_heap.data(), heap_data);
+  EXPECT_TRUE(heap_v.is_inline());
+  EXPECT_TRUE(heap_v.empty());
+
+  moved_inline.swap(moved_heap);
+  EXPECT_EQ(moved_inline.size(), 4);
+  EXPECT_EQ(moved_heap.size(), 2);
+  EXPECT_EQ(moved_heap[0], "a");
+  EXPECT_EQ(moved_inline[3], "f");
+}
+
+TEST(SmallVectorTest, StatefulAllocatorTest) {
+  using arena_vector =
+      small_vector<std::string, 2, arena_allocator<std::string>>;
+  arena_stats r1, r2;
+  {
+    arena_vector a({"a", "b", "c", "d"}, arena_allocator<std::string>(&r1));
+    arena_vector b({"x", "y", "z"}, arena_allocator<std::string>(&r2));
+    auto *a_data = a.data();
+
+    // b can't adopt a's buffer: the elements move into r2's storage
+    b = std::move(a);
+    EXPECT_EQ(b, (arena_vector({"a", "b", "c", "d"},
+                               arena_allocator<std::string>(&r2))));
+    EXPECT_NE(b.data(), a_data);
+    EXPECT_TRUE(a.empty());
+    EXPECT_EQ(b.get_allocator(), arena_allocator<std::string>(&r2));
+
+    // equal allocators: the buffer itself changes hands
+    arena_vector c({"p", "q", "r"}, arena_allocator<std::string>(&r2));
+    auto *b_data = b.data();
+    c = std::move(b);
+    EXPECT_EQ(c.data(), b_data);
+
+    // two heap buffers swap without touching the elements
+    arena_vector d({"s", "t", "u"}, arena_allocator<std::string>(&r2));
+    auto *d_data = d.data();
+    c.swap(d);
+    EXPECT_EQ(c.data(), d_data);
+    EXPECT_EQ(d.data(), b_data);
+    EXPECT_EQ(c.size(), 3);
+  }
+  EXPECT_EQ(r1.live, 0);
+  EXPECT_EQ(r2.live, 0);
+}
+
+TEST(SmallVectorTest, InsertEraseTest) {
+  small_vector<std::string, 4> v{"1", "2", "3"};
+
+  v.insert(v.begin() + 1, 2, "x");
+  EXPECT_EQ(v, (small_vector<std::string, 4>{"1", "x", "x", "2", "3"}));
+
+  v.insert(v.begin(), {"a", "b"});
+  v.emplace(v.begin() + 3, "y");
+  EXPECT_EQ(v, (small_vector<std::string, 4>{"a", "b", "1", "y", "x", "x",
+                                             "2", "3"}));
+
+  v.erase(v.begin() + 2, v.begin() + 6);
+  v.erase(v.begin());
+  EXPECT_EQ(v, (small_vector<std::string, 4>{"b", "2", "3"}));
+
+  // self-referencing insert
+  v.insert(v.begin(), 3, v[2]);
+  EXPECT_EQ(v.front(), "3");
+  EXPECT_EQ(v.size(), 6);
+}
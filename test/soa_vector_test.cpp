@@ -0,0 +1,92 @@
+#include "../my/soa_vector.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <numeric>
+#include <string>
+#include <tuple>
+
+using namespace my;
+
+TEST(SoaVectorTest, ColumnsTest) {
+  soa_vector<int, double, char> v;
+  EXPECT_TRUE(v.empty());
+  for (int i = 0; i < 100; ++i) {
+    v.emplace_back(i, i * 0.5, static_cast<char>('a' + i % 26));
+  }
+  EXPECT_EQ(v.size(), 100);
+  EXPECT_GE(v.capacity(), 100);
+
+  auto ints = v.column<0>();
+  auto doubles = v.column<1>();
+  auto chars = v.column<2>();
+  EXPECT_EQ(ints.size(), 100);
+  EXPECT_EQ(std::accumulate(ints.begin(), ints.end(), 0), 4950);
+  EXPECT_DOUBLE_EQ(doubles[10], 5.0);
+  EXPECT_EQ(chars[27], 'b');
+
+  // every column starts on its own cache line
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(ints.data()) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(doubles.data()) % 64, 0);
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(chars.data()) % 64, 0);
+
+  // rows are tuples of references into the columns
+  auto [i, d, c] = v[3];
+  i = 42;
+  d = 1.5;
+  c = 'z';
+  EXPECT_EQ(v.column<0>()[3], 42);
+  EXPECT_EQ(v[3], std::make_tuple(42, 1.5, 'z'));
+  EXPECT_THROW(v.at(100), std::out_of_range);
+
+  std::size_t rows = 0;
+  for (auto [x, y, z] : v) {
+    x += 1;
+    ++rows;
+  }
+  EXPECT_EQ(rows, 100);
+  EXPECT_EQ(std::get<0>(v.front()), 1);
+  EXPECT_EQ(std::get<0>(v.back()), 100);
+  EXPECT_EQ(v.end() - v.begin(), 100);
+}
+
+TEST(SoaVectorTest, InsertEraseTest) {
+  soa_vector<std::string, int> v{{"a", 1}, {"b", 2}, {"c", 3}};
+  v.reserve(3);
+  v.insert(v.begin() + 1, {"x", 10});
+  EXPECT_EQ(v.size(), 4);
+  EXPECT_EQ(std::get<0>(v[1]), "x");
+  EXPECT_EQ(std::get<1>(v[2]), 2);
+
+  v.emplace(v.end(), "d", 4);
+  v.emplace(v.begin(), "first", 0);
+  EXPECT_EQ(std::get<0>(v.front()), "first");
+  EXPECT_EQ(std::get<0>(v.back()), "d");
+
+  auto it = v.erase(v.begin() + 1, v.begin() + 3);
+  EXPECT_EQ(it.index(), 1);
+  EXPECT_EQ(v.size(), 4);
+  EXPECT_EQ(std::get<0>(v[1]), "b");
+  v.erase(v.begin());
+  v.pop_back();
+  EXPECT_EQ(v, (soa_vector<std::string, int>{{"b", 2}, {"c", 3}}));
+
+  auto copy = v;
+  EXPECT_EQ(copy, v);
+  std::get<1>(copy[0]) = 7;
+  EXPECT_FALSE(copy == v);
+
+  auto moved = std::move(copy);
+  EXPECT_TRUE(copy.empty());
+  EXPECT_EQ(std::get<1>(moved[0]), 7);
+
+  moved.resize(5);
+  EXPECT_EQ(moved.size(), 5);
+  EXPECT_EQ(std::get<0>(moved[4]), "");
+  EXPECT_EQ(std::get<1>(moved[4]), 0);
+  moved.resize(1);
+  moved.shrink_to_fit();
+  EXPECT_EQ(moved.capacity(), 1);
+  moved.clear();
+  moved.shrink_to_fit();
+  EXPECT_EQ(moved.capacity(), 0);
+}
@@ -0,0 +1,126 @@
+#define MY_STL_ENABLE_TRACING
+#include "../my/list.h"
+#include "../my/trace_dump.h"
+#include "../my/vector.h"
+#include <cstdint>
+#include <gtest/gtest.h>
+#include <sstream>
+#include <string>
+#include <thread>
+
+using namespace my;
+
+namespace {
+// the recorded events of one container, oldest first; the container is
+// identified by its address, which may already be freed
+vector<trace::event> events_for(std::uintptr_t object) {
+  vector<trace::event> out;
+  for (const auto &e : trace::snapshot()) {
+    if (reinterpret_cast<std::uintptr_t>(e.object) == object) {
+      out.push_back(e);
+    }
+  }
+  return out;
+}
+} // namespace
+
+TEST(TraceTest, VectorEventsTest) {
+  vector<int> v;
+  std::size_t reallocations = 0;
+  {
+    trace::scope tag("fill_loop");
+    for (int i = 0; i < 1000; ++i) {
+      auto cap = v.capacity();
+      v.push_back(i);
+      reallocations += v.capacity() != cap;
+    }
+  }
+  v.resize(10);
+  v.shrink_to_fit();
+  v.insert(v.begin() + 5, std::size_t{20000}, 7);
+
+  auto events = events_for(reinterpret_cast<std::uintptr_t>(&v));
+  ASSERT_EQ(events.size(), reallocations + 3);
+  std::size_t old_cap = 0;
+  for (std::size_t i = 0; i < reallocations; ++i) {
+    EXPECT_EQ(events[i].kind, trace::event_kind::growth);
+    EXPECT_STREQ(events[i].tag, "fill_loop");
+    EXPECT_EQ(events[i].a, old_cap);
+    EXPECT_GT(events[i].b, events[i].a);
+    EXPECT_EQ(events[i].c, old_cap * sizeof(int));
+    old_cap = events[i].b;
+    if (i > 0) {
+      EXPECT_GE(events[i].timestamp_ns, events[i - 1].timestamp_ns);
+    }
+  }
+
+  const auto &shrink = events[reallocations];
+  EXPECT_EQ(shrink.kind, trace::event_kind::shrink);
+  EXPECT_EQ(shrink.tag, nullptr);
+  EXPECT_EQ(shrink.b, 10);
+  EXPECT_EQ(shrink.c, 10 * sizeof(int));
+
+  const auto &insert = events[reallocations + 1];
+  EXPECT_EQ(insert.kind, trace::event_kind::large_insert);
+  EXPECT_EQ(insert.a, 20000);
+  EXPECT_EQ(insert.b, 20000 * sizeof(int));
+  EXPECT_EQ(insert.c, 5);
+  EXPECT_EQ(events[reallocations + 2].kind, trace::event_kind::growth);
+  EXPECT_EQ(events[reallocations + 2].c, 10 * sizeof(int));
+
+  std::ostringstream summary;
+  trace::summarize(summary, events);
+  EXPECT_NE(summary.str().find("fill_loop growth " +
+                               std::to_string(reallocations)),
+            std::string::npos);
+}
+
+TEST(TraceTest, ListNodeEventsTest) {
+  auto *l = new list<std::string>;
+  {
+    trace::scope tag("names");
+    l->push_back("a");
+    l->push_back("b");
+    l->emplace(l->begin(), "c");
+  }
+  auto object = reinterpret_cast<std::uintptr_t>(l);
+  delete l;
+
+  auto events = events_for(object);
+  ASSERT_EQ(events.size(), 6);
+  for (std::size_t i = 0; i < 3; ++i) {
+    EXPECT_EQ(events[i].kind, trace::event_kind::node_alloc);
+    EXPECT_STREQ(events[i].tag, "names");
+    EXPECT_EQ(events[i + 3].kind, trace::event_kind::node_free);
+    EXPECT_EQ(events[i + 3].tag, nullptr);
+  }
+
+  std::ostringstream out;
+  trace::dump(out, events);
+  EXPECT_NE(out.str().find(" node_alloc names "), std::string::npos);
+}
+
+TEST(TraceTest, RingPerThreadTest) {
+  constexpr std::size_t ring_size = trace::detail::ring::ring_size;
+  list<int> l;
+
+  std::thread worker([&] {
+    // the frees lap the allocations: only the last ring_size events survive
+    for (std::size_t i = 0; i < ring_size; ++i) {
+      l.push_back(0);
+    }
+    l.clear();
+  });
+  worker.join();
+  l.push_back(1);
+
+  auto events = events_for(reinterpret_cast<std::uintptr_t>(&l));
+  ASSERT_EQ(events.size(), ring_size + 1);
+  auto worker_thread = events.front().thread;
+  for (std::size_t i = 0; i < ring_size; ++i) {
+    EXPECT_EQ(events[i].kind, trace::event_kind::node_free);
+    EXPECT_EQ(events[i].thread, worker_thread);
+  }
+  EXPECT_EQ(events.back().kind, trace::event_kind::node_alloc);
+  EXPECT_NE(events.back().thread, worker_thread);
+}
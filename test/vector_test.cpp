@@ -1,5 +1,12 @@
 #include "../my/vector.h"
+#include "../my/huge_page_resource.h"
+#include "../my/mmap_allocator.h"
+#include <atomic>
+#include <cstdint>
 #include <gtest/gtest.h>
+#include <numeric>
+#include <ranges>
+#include <sstream>
 #include <vector>
 
 using namespace my;
@@ -315,3 +322,686 @@ TEST(VectorTest, ExceptionSafetyTest) {
   EXPECT_NO_THROW(v.at(0));
   EXPECT_THROW(v.at(1), std::out_of_range);
 }
+
+// Allocator tests
+template <class T> struct counting_allocator {
+  using value_type = T;
+
+  std::size_t *allocations;
+  std::size_t *deallocations;
+
+  counting_allocator(std::size_t *a, std::size_t *d)
+      : allocations{a}, deallocations{d} {}
+  template <class U>
+  counting_allocator(const counting_allocator<U> &other)
+      : allocations{other.allocations}, deallocations{other.deallocations} {}
+
+  T *allocate(std::size_t n) {
+    ++*allocations;
+    return std::allocator<T>{}.allocate(n);
+  }
+  void deallocate(T *p, std::size_t n) {
+    ++*deallocations;
+    std::allocator<T>{}.deallocate(p, n);
+  }
+
+  bool operator==(const counting_allocator &) const = default;
+};
+
+TEST(VectorTest, CustomAllocatorTest) {
+  std::size_t allocations = 0;
+  std::size_t deallocations = 0;
+  counting_allocator<std::string> alloc{&allocations, &deallocations};
+  {
+    vector<std::string, counting_allocator<std::string>> v(alloc);
+    for (int i = 0; i < 10; ++i) {
+      v.push_back(std::to_string(i));
+    }
+    EXPECT_EQ(v.size(), 10);
+    EXPECT_EQ(v[9], "9");
+    EXPECT_GT(allocations, 0);
+    EXPECT_EQ(v.get_allocator(), alloc);
+
+    auto copied = v;
+    EXPECT_EQ(copied, v);
+  }
+  EXPECT_EQ(allocations, deallocations);
+}
+
+TEST(VectorTest, AllocateAtLeastTest) {
+  allocator<int> alloc;
+  auto [ptr, count] = alloc.allocate_at_least(3);
+  EXPECT_NE(ptr, nullptr);
+  EXPECT_GE(count, 3);
+  alloc.deallocate(ptr, count);
+
+  // the slack reported by the allocator shows up as capacity
+  vector<int> v;
+  v.reserve(3);
+  EXPECT_GE(v.capacity(), 3);
+  auto cap = v.capacity();
+  for (std::size_t i = 0; i < cap; ++i) {
+    v.push_back(static_cast<int>(i));
+  }
+  EXPECT_EQ(v.capacity(), cap);
+}
+
+// Relocation tests
+struct relocatable_handle {
+  static inline int moves = 0;
+  std::unique_ptr<int> value;
+
+  explicit relocatable_handle(int v) : value{std::make_unique<int>(v)} {}
+  relocatable_handle(relocatable_handle &&other) noexcept
+      : value{std::move(other.value)} {
+    ++moves;
+  }
+  relocatable_handle &operator=(relocatable_handle &&other) noexcept {
+    value = std::move(other.value);
+    ++moves;
+    return *this;
+  }
+};
+
+template <>
+struct my::is_trivially_relocatable<relocatable_handle> : my::true_type {};
+
+TEST(VectorTest, TriviallyRelocatableTraitTest) {
+  static_assert(is_trivially_relocatable_v<int>);
+  static_assert(is_trivially_relocatable_v<std::unique_ptr<int>>);
+  static_assert(!is_trivially_relocatable_v<std::vector<int>>);
+  static_assert(is_trivially_relocatable_v<relocatable_handle>);
+}
+
+TEST(VectorTest, RelocateWithoutMovingTest) {
+  vector<relocatable_handle> v;
+  for (int i = 0; i < 5; ++i) {
+    v.emplace_back(i);
+  }
+  relocatable_handle::moves = 0;
+
+  v.reserve(100);
+  v.erase(v.begin() + 1);
+  v.erase(v.begin(), v.begin() + 2);
+  v.shrink_to_fit();
+  EXPECT_EQ(relocatable_handle::moves, 0);
+
+  ASSERT_EQ(v.size(), 2);
+  EXPECT_EQ(*v[0].value, 3);
+  EXPECT_EQ(*v[1].value, 4);
+}
+
+TEST(VectorTest, RelocatingInsertEraseTest) {
+  vector<std::unique_ptr<int>> v;
+  for (int i = 0; i < 6; ++i) {
+    v.push_back(std::make_unique<int>(i));
+  }
+
+  v.insert(v.begin() + 2, std::make_unique<int>(42));
+  v.emplace(v.begin(), std::make_unique<int>(-1));
+  ASSERT_EQ(v.size(), 8);
+  EXPECT_EQ(*v[0], -1);
+  EXPECT_EQ(*v[3], 42);
+  EXPECT_EQ(*v[7], 5);
+
+  v.erase(v.begin() + 3);
+  v.erase(v.begin(), v.begin() + 2);
+  ASSERT_EQ(v.size(), 5);
+  for (int i = 0; i < 5; ++i) {
+    EXPECT_EQ(*v[i], i + 1);
+  }
+
+  vector<int> ints{1, 2, 3, 4, 5};
+  ints.insert(ints.begin() + 1, 3, ints[4]);
+  ints.insert(ints.begin(), {7, 8});
+  EXPECT_EQ(ints, (vector<int>{7, 8, 1, 5, 5, 5, 2, 3, 4, 5}));
+}
+
+// Growth policy tests
+TEST(VectorTest, GrowthPolicyTest) {
+  static_assert(double_growth::next_capacity(8, 9, 4) == 16);
+  static_assert(one_and_half_growth::next_capacity(8, 9, 4) == 12);
+  static_assert(one_and_half_growth::next_capacity(1, 2, 4) == 2);
+  static_assert(page_growth<4096>::next_capacity(8, 9, 4) == 1024);
+  static_assert(chunk_growth<100>::next_capacity(100, 101, 4) == 200);
+
+  vector<int, std::allocator<int>, chunk_growth<100>> chunked;
+  for (int i = 0; i < 150; ++i) {
+    chunked.push_back(i);
+  }
+  EXPECT_EQ(chunked.capacity(), 200);
+
+  vector<int, std::allocator<int>, one_and_half_growth> v;
+  v.reserve(10);
+  v.resize(10, 1);
+  v.push_back(2);
+  EXPECT_EQ(v.capacity(), 15);
+  EXPECT_EQ(v.back(), 2);
+}
+
+TEST(VectorTest, MmapAllocatorTest) {
+  // a small threshold so the test crosses into mapped storage quickly
+  vector<int, mmap_allocator<int, 4096>> v;
+  for (int i = 0; i < 100000; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_GE(v.capacity(), 100000);
+  for (int i = 0; i < 100000; ++i) {
+    ASSERT_EQ(v[i], i);
+  }
+
+  v.insert(v.begin() + 1, 3, v[0]);
+  EXPECT_EQ(v[3], 0);
+  EXPECT_EQ(v[4], 1);
+
+  v.resize(10);
+  v.shrink_to_fit();
+  EXPECT_EQ(v.size(), 10);
+  EXPECT_EQ(v[9], 6);
+
+  auto copied = v;
+  EXPECT_EQ(copied, v);
+
+  // elements larger than a page: the mapping length must survive the round
+  // trip through the reported capacity
+  struct block {
+    std::uint64_t words[1000];
+  };
+  vector<block, mmap_allocator<block, 4096>> blocks;
+  for (std::uint64_t i = 0; i < 64; ++i) {
+    blocks.push_back(block{{i}});
+    blocks.back().words[999] = i;
+  }
+  EXPECT_EQ(blocks[63].words[0], 63);
+  EXPECT_EQ(blocks[40].words[999], 40);
+  blocks.resize(3);
+  blocks.shrink_to_fit();
+  EXPECT_EQ(blocks[2].words[999], 2);
+}
+
+TEST(VectorTest, HugePageAllocatorTest) {
+  auto *p = static_cast<char *>(huge_page_resource{}.allocate(
+      huge_page_resource::huge_page_size + 1));
+  EXPECT_EQ(reinterpret_cast<std::uintptr_t>(p) %
+                huge_page_resource::huge_page_size,
+            0);
+  p[0] = 1;
+  p[huge_page_resource::huge_page_size] = 2;
+  huge_page_resource{}.deallocate(p, huge_page_resource::huge_page_size + 1);
+
+  vector<std::uint64_t, huge_page_allocator<std::uint64_t>> v;
+  v.reserve(1 << 20);
+  EXPECT_EQ(v.capacity() * sizeof(std::uint64_t) %
+                huge_page_resource::huge_page_size,
+            0);
+  for (std::uint64_t i = 0; i < (1 << 20) + 1; ++i) {
+    v.push_back(i);
+  }
+  EXPECT_EQ(v[1 << 20], 1 << 20);
+
+  vector<int, huge_page_allocator<int>> small{1, 2, 3};
+  EXPECT_EQ(small[2], 3);
+}
+
+// Default initialization tests
+TEST(VectorTest, DefaultInitTest) {
+  vector<int> v(default_init, 16);
+  EXPECT_EQ(v.size(), 16);
+  std::fill(v.begin(), v.end(), 7);
+
+  v.resize_for_overwrite(32);
+  EXPECT_EQ(v.size(), 32);
+  EXPECT_EQ(v[15], 7);
+  std::memset(v.data() + 16, 0, 16 * sizeof(int));
+  EXPECT_EQ(v[31], 0);
+
+  v.resize_for_overwrite(4);
+  EXPECT_EQ(v.size(), 4);
+
+  auto *tail = v.append_uninitialized(3);
+  EXPECT_EQ(tail, v.data() + 4);
+  EXPECT_EQ(v.size(), 7);
+  std::memcpy(tail, v.data(), 3 * sizeof(int));
+  EXPECT_EQ(v[6], 7);
+
+  // non-trivial types are still default constructed
+  vector<std::string> strings(default_init, 2);
+  strings.append_uninitialized(2);
+  EXPECT_EQ(strings.size(), 4);
+  EXPECT_EQ(strings[3], "");
+
+  // value-initialization still zeroes
+  vector<int> zeros(8);
+  for (auto z : zeros) {
+    EXPECT_EQ(z, 0);
+  }
+}
+
+// Range member tests
+TEST(VectorTest, AppendInsertRangeTest) {
+  vector<int> v{1, 2, 3};
+
+  // sized range: one allocation for the whole append
+  std::vector<int> src(100, 9);
+  v.append_range(src);
+  EXPECT_EQ(v.size(), 103);
+  EXPECT_EQ(v.back(), 9);
+
+  v.insert_range(v.begin() + 1, std::views::iota(10, 13));
+  EXPECT_EQ(v[0], 1);
+  EXPECT_EQ(v[1], 10);
+  EXPECT_EQ(v[3], 12);
+  EXPECT_EQ(v[4], 2);
+
+  // unsized input range
+  std::istringstream in("7 8 9");
+  v.insert_range(v.begin(), std::views::istream<int>(in));
+  EXPECT_EQ(v[0], 7);
+  EXPECT_EQ(v[2], 9);
+  EXPECT_EQ(v[3], 1);
+  EXPECT_EQ(v.size(), 109);
+
+  // input iterators through the classic overload
+  std::istringstream in2("4 5");
+  v.insert(v.end(), std::istream_iterator<int>(in2),
+           std::istream_iterator<int>());
+  EXPECT_EQ(v.back(), 5);
+
+  // forward, non-sized range of non-trivial elements
+  vector<std::string> strings{"a", "b", "c", "d"};
+  auto evens = std::views::iota(0, 4) |
+               std::views::filter([](int i) { return i % 2 == 0; }) |
+               std::views::transform([](int i) { return std::to_string(i); });
+  strings.insert_range(strings.begin() + 1, evens);
+  EXPECT_EQ(strings, (vector<std::string>{"a", "0", "2", "b", "c", "d"}));
+}
+
+TEST(VectorTest, AssignRangeTest) {
+  vector<std::string> v;
+  v.reserve(10);
+  auto *storage = v.data();
+  v.append_range(std::vector<std::string>{"x", "y", "z"});
+
+  v.assign_range(std::vector<std::string>{"a", "b", "c", "d", "e"});
+  EXPECT_EQ(v, (vector<std::string>{"a", "b", "c", "d", "e"}));
+  EXPECT_EQ(v.data(), storage);
+
+  v.assign_range(std::vector<std::string>{"q"});
+  EXPECT_EQ(v, (vector<std::string>{"q"}));
+  EXPECT_EQ(v.data(), storage);
+
+  std::istringstream in("1 2 3");
+  vector<int> ints{9, 9, 9, 9, 9};
+  ints.assign_range(std::views::istream<int>(in));
+  EXPECT_EQ(ints, (vector<int>{1, 2, 3}));
+
+  ints.assign_range(std::views::iota(0, 50));
+  EXPECT_EQ(ints.size(), 50);
+  EXPECT_EQ(ints[49], 49);
+}
+
+// Parallel construction tests
+struct counted {
+  static inline std::atomic<int> alive = 0;
+  static inline std::atomic<int> copies_left = 1 << 30;
+  int value = 0;
+
+  counted() { ++alive; }
+  explicit counted(int v) : value{v} { ++alive; }
+  counted(const counted &other) : value{other.value} {
+    if (--copies_left < 0)
+      throw std::runtime_error("copy failed");
+    ++alive;
+  }
+  ~counted() { --alive; }
+};
+
+TEST(VectorTest, ParallelConstructionTest) {
+  constexpr std::size_t count = 3'000'000;
+
+  vector<int> filled(execution::par, count, 7);
+  EXPECT_EQ(filled.size(), count);
+  EXPECT_EQ(std::count(filled.begin(), filled.end(), 7), count);
+
+  vector<int> zeros(execution::par, count);
+  EXPECT_EQ(std::count(zeros.begin(), zeros.end(), 0), count);
+
+  std::iota(filled.begin(), filled.end(), 0);
+  vector<int> copied(execution::par, filled);
+  EXPECT_EQ(copied, filled);
+
+  copied.resize(execution::par, 2 * count, -1);
+  EXPECT_EQ(copied.size(), 2 * count);
+  EXPECT_EQ(copied[count - 1], static_cast<int>(count - 1));
+  EXPECT_EQ(copied[count], -1);
+  EXPECT_EQ(copied.back(), -1);
+
+  copied.resize(execution::par, 10);
+  EXPECT_EQ(copied.size(), 10);
+}
+
+TEST(VectorTest, ParallelConstructionExceptionTest) {
+  counted::alive = 0;
+  {
+    vector<counted> source(execution::par, 1'000'000, counted{1});
+    EXPECT_EQ(counted::alive, 1'000'000);
+
+    counted::copies_left = 700'000;
+    EXPECT_THROW(vector<counted>(execution::par, source), std::runtime_error);
+    EXPECT_EQ(counted::alive, 1'000'000);
+    counted::copies_left = 1 << 30;
+  }
+  EXPECT_EQ(counted::alive, 0);
+}
+
+template <class T> void check_against_std(std::size_t n) {
+  std::vector<T> base(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    base[i] = static_cast<T>(i * 37 % 101) - static_cast<T>(50);
+  }
+  for (std::size_t pos = 0; pos <= n; ++pos) {
+    auto other = base;
+    if (pos < n) {
+      other[pos] = static_cast<T>(other[pos] + 1);
+    }
+    vector<T> a(base.begin(), base.end());
+    vector<T> b(other.begin(), other.end());
+    EXPECT_EQ(a == b, base == other) << n << " " << pos;
+    EXPECT_EQ(a <=> b, base <=> other) << n << " " << pos;
+    EXPECT_EQ(b <=> a, other <=> base) << n << " " << pos;
+
+    // proper prefix
+    vector<T> prefix(base.begin(), base.begin() + pos);
+    EXPECT_EQ(prefix == a, pos == n);
+    EXPECT_EQ(prefix <=> a, (std::vector<T>(base.begin(), base.begin() + pos)
+                             <=> base));
+  }
+}
+
+TEST(VectorTest, SimdComparisonTest) {
+  for (std::size_t n : {0, 1, 3, 15, 16, 17, 31, 33, 64, 65, 130}) {
+    check_against_std<signed char>(n);
+    check_against_std<short>(n);
+    check_against_std<int>(n);
+    check_against_std<unsigned long long>(n);
+    check_against_std<float>(n);
+    check_against_std<double>(n);
+  }
+
+  // signed elements must not compare as raw bytes
+  EXPECT_LT((vector<int>{-1}), (vector<int>{0}));
+  EXPECT_LT((vector<int>{256, -5}), (vector<int>{256, 1}));
+
+  // floating point equality, not bitwise equality
+  constexpr auto nan = std::numeric_limits<double>::quiet_NaN();
+  vector<double> zeros(40, 0.0);
+  vector<double> neg_zeros(40, -0.0);
+  EXPECT_EQ(zeros, neg_zeros);
+  EXPECT_EQ(zeros <=> neg_zeros, std::partial_ordering::equivalent);
+
+  vector<double> with_nan(40, 0.0);
+  with_nan[37] = nan;
+  EXPECT_NE(with_nan, with_nan);
+  EXPECT_EQ(with_nan <=> zeros, std::partial_ordering::unordered);
+
+  vector<float> fnan(21, 1.0f);
+  fnan[20] = std::numeric_limits<float>::quiet_NaN();
+  EXPECT_NE(fnan, fnan);
+  EXPECT_EQ(fnan <=> fnan, std::partial_ordering::unordered);
+}
+
+TEST(VectorTest, EraseIfTest) {
+  struct pair32 {
+    int key;
+    int value;
+    bool operator==(const pair32 &) const = default;
+  };
+
+  for (std::size_t n : {0, 1, 7, 8, 16, 33, 1000, 100'003}) {
+    std::vector<int> expected(n);
+    std::iota(expected.begin(), expected.end(), 0);
+    vector<int> v(expected.begin(), expected.end());
+
+    std::size_t calls = 0;
+    auto pred = [&calls](int x) {
+      ++calls;
+      return x % 3 == 0 || x % 7 == 1;
+    };
+    auto removed = erase_if(v, pred);
+    EXPECT_EQ(calls, n);
+    EXPECT_EQ(removed, std::erase_if(expected, [](int x) {
+                return x % 3 == 0 || x % 7 == 1;
+              }));
+    EXPECT_TRUE(std::ranges::equal(v, expected)) << n;
+
+    vector<pair32> pairs;
+    vector<double> doubles;
+    std::vector<double> expected_doubles;
+    for (std::size_t i = 0; i < n; ++i) {
+      pairs.push_back({static_cast<int>(i % 5), static_cast<int>(i)});
+      doubles.push_back(static_cast<double>(i % 4));
+      expected_doubles.push_back(static_cast<double>(i % 4));
+    }
+    EXPECT_EQ(erase(pairs, pair32{0, 0}), n > 0 ? 1u : 0u);
+    EXPECT_EQ(erase_if(pairs, [](const pair32 &p) { return p.key != 2; }),
+              n == 0 ? 0 : n - 1 - (n + 2) / 5);
+    for (auto &p : pairs) {
+      EXPECT_EQ(p.key, 2);
+    }
+    EXPECT_TRUE(std::ranges::is_sorted(pairs, {}, &pair32::value));
+
+    EXPECT_EQ(erase(doubles, 1.0), std::erase(expected_doubles, 1.0));
+    EXPECT_TRUE(std::ranges::equal(doubles, expected_doubles));
+  }
+
+  // everything else takes the generic path
+  vector<std::string> words{"a", "bb", "c", "dd", "e"};
+  EXPECT_EQ(erase_if(words, [](const auto &w) { return w.size() == 2; }), 2);
+  EXPECT_EQ(words, (vector<std::string>{"a", "c", "e"}));
+  EXPECT_EQ(erase(words, "c"), 1);
+  EXPECT_EQ(words, (vector<std::string>{"a", "e"}));
+}
+
+TEST(VectorTest, VectorBoolTest) {
+  static_assert(std::random_access_iterator<vector<bool>::iterator>);
+  static_assert(std::random_access_iterator<vector<bool>::const_iterator>);
+
+  vector<bool> v;
+  std::vector<bool> expected;
+  for (std::size_t i = 0; i < 1000; ++i) {
+    bool bit = i % 3 == 0 || i % 64 == 63;
+    v.push_back(bit);
+    expected.push_back(bit);
+  }
+  EXPECT_EQ(v.size(), 1000);
+  EXPECT_GE(v.capacity(), 1000);
+  EXPECT_EQ(v.word_count(), 16);
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+
+  // proxy references
+  v[1] = true;
+  expected[1] = true;
+  v[0].flip();
+  expected[0].flip();
+  EXPECT_FALSE(v.front());
+  EXPECT_TRUE(v[1]);
+  vector<bool>::swap(v[0], v[1]);
+  std::vector<bool>::swap(expected[0], expected[1]);
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+  EXPECT_THROW(v.at(1000), std::out_of_range);
+
+  // insert and erase shift across word boundaries
+  v.insert(v.begin() + 5, 70, true);
+  expected.insert(expected.begin() + 5, 70, true);
+  v.erase(v.begin() + 100, v.begin() + 300);
+  expected.erase(expected.begin() + 100, expected.begin() + 300);
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+
+  // resize keeps the tail bits clear
+  v.resize(10);
+  v.resize(200, false);
+  expected.resize(10);
+  expected.resize(200, false);
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+  v.resize(300, true);
+  expected.resize(300, true);
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+  v.pop_back();
+  expected.pop_back();
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+
+  v.flip();
+  expected.flip();
+  EXPECT_TRUE(std::ranges::equal(v, expected));
+  EXPECT_EQ(v.count(), std::ranges::count(expected, true));
+
+  vector<bool> copy(v);
+  EXPECT_EQ(copy, v);
+  copy.push_back(false);
+  EXPECT_LT(v, copy);
+  EXPECT_NE(v, copy);
+  EXPECT_EQ(my::erase(copy, false), std::erase(expected, false) + 1);
+  EXPECT_TRUE(std::ranges::all_of(copy, std::identity{}));
+
+  // popping an empty vector is a no-op, as for my::vector
+  vector<bool> empty;
+  empty.pop_back();
+  EXPECT_TRUE(empty.empty());
+  empty.push_back(true);
+  empty.pop_back();
+  empty.pop_back();
+  EXPECT_EQ(empty.size(), 0);
+}
+
+TEST(VectorTest, VectorBoolWordAlgorithmsTest) {
+  constexpr std::size_t n = 10'000;
+  vector<bool> a(n);
+  vector<bool> b(n, true);
+  std::vector<std::size_t> set;
+  for (std::size_t i = 0; i < n; i += 97) {
+    a[i] = true;
+    set.push_back(i);
+  }
+  a[n - 1] = true;
+  set.push_back(n - 1);
+
+  EXPECT_EQ(a.count(), set.size());
+  EXPECT_EQ(b.count(), n);
+  EXPECT_EQ(vector<bool>(n).find_first(), vector<bool>::npos);
+
+  std::vector<std::size_t> found;
+  for (auto i = a.find_first(); i != vector<bool>::npos; i = a.find_next(i)) {
+    found.push_back(i);
+  }
+  EXPECT_EQ(found, set);
+
+  for (std::size_t pos : {std::size_t{0}, std::size_t{1}, std::size_t{64},
+                          std::size_t{97}, std::size_t{98}, std::size_t{4000},
+                          n - 1, n}) {
+    auto expected = static_cast<std::size_t>(
+        std::ranges::count_if(set, [pos](std::size_t i) { return i < pos; }));
+    EXPECT_EQ(a.rank(pos), expected) << pos;
+  }
+
+  EXPECT_EQ((a & b), a);
+  EXPECT_EQ((a | b), b);
+  auto x = a ^ b;
+  EXPECT_EQ(x.count(), n - a.count());
+  x |= a;
+  EXPECT_EQ(x, b);
+  x &= vector<bool>(n);
+  EXPECT_EQ(x.count(), 0);
+  EXPECT_THROW(x ^= vector<bool>(n + 1), std::invalid_argument);
+
+  // 64 flags per word
+  EXPECT_EQ(a.word_count(), (n + 63) / 64);
+  EXPECT_EQ(vector<bool>(64) <=> vector<bool>(64),
+            std::strong_ordering::equal);
+  vector<bool> lo(130);
+  vector<bool> hi(130);
+  hi[129] = true;
+  EXPECT_LT(lo, hi);
+  lo[128] = true;
+  EXPECT_GT(lo, hi);
+}
+
+namespace {
+// exercises growth, insertion, erasure and copies during constant evaluation
+constexpr vector<int> make_squares(int n) {
+  vector<int> v;
+  for (int i = 0; i < n; ++i) {
+    v.push_back(i * i);
+  }
+  v.insert(v.begin(), -1);
+  v.insert(v.begin() + 2, std::size_t{3}, 7);
+  v.erase(v.begin() + 2, v.begin() + 5);
+  v.erase(v.begin());
+  vector<int> copy = v;
+  copy.reserve(4 * copy.capacity());
+  copy.shrink_to_fit();
+  erase_if(copy, [](int x) { return x % 2 != 0; });
+  copy.resize(copy.size() + 1, 0);
+  return copy;
+}
+
+constexpr bool constexpr_strings() {
+  vector<std::string> v{"b", "c"};
+  v.emplace(v.begin(), "a");
+  v.insert(v.end(), {"d", "e"});
+  vector<std::string> moved = std::move(v);
+  moved.pop_back();
+  return moved == vector<std::string>{"a", "b", "c", "d"} && v.empty() &&
+         (moved <=> vector<std::string>{"a", "c"}) < 0;
+}
+} // namespace
+
+TEST(VectorTest, ConstexprTest) {
+  static_assert(make_squares(10).size() == 6);
+  static_assert(make_squares(10)[5] == 0);
+  static_assert(make_squares(10) == vector<int>{0, 4, 16, 36, 64, 0});
+  static_assert(constexpr_strings());
+
+  constexpr auto table = freeze<[] { return make_squares(1000); }>();
+  static_assert(table.size() == 501);
+  static_assert(table[250] == 500 * 500);
+
+  auto runtime = make_squares(1000);
+  EXPECT_TRUE(std::equal(table.begin(), table.end(), runtime.begin(),
+                         runtime.end()));
+}
+
+TEST(VectorTest, AlignedAllocationTest) {
+  struct alignas(64) line {
+    float lanes[16];
+  };
+  auto aligned = [](const void *p, std::size_t a) {
+    return reinterpret_cast<std::uintptr_t>(p) % a == 0;
+  };
+
+  // over-aligned element types get their own alignment without asking
+  vector<line> lines;
+  for (int i = 0; i < 9; ++i) {
+    lines.push_back(line{});
+    ASSERT_TRUE(aligned(lines.data(), alignof(line)));
+  }
+  lines.shrink_to_fit();
+  EXPECT_TRUE(aligned(lines.data(), alignof(line)));
+
+  // plain floats on a 64-byte boundary through every reallocation
+  aligned_vector<float, 64> floats;
+  for (int i = 0; i < 1000; ++i) {
+    floats.push_back(static_cast<float>(i));
+    ASSERT_TRUE(aligned(floats.data(), 64));
+  }
+  aligned_vector<float, 64> copy(floats);
+  EXPECT_TRUE(aligned(copy.data(), 64));
+  EXPECT_EQ(copy, floats);
+  copy.insert(copy.begin() + 3, 100, 1.0f);
+  EXPECT_TRUE(aligned(copy.data(), 64));
+
+  static_assert(allocator<float, 64>::alignment == 64);
+  static_assert(allocator<line>::alignment == 64);
+  static_assert(std::is_same_v<std::allocator_traits<allocator<float, 64>>::
+                                   rebind_alloc<double>,
+                               allocator<double, 64>>);
+}